@@ -0,0 +1,215 @@
+// Synthetic benchmark: drones flying circles around a site covered by a grid of scanners. Every drone transmits a
+// Basic ID + Location pack every 100 ms, and every scanner in range receives it with RSSI from the path loss model plus
+// fading noise, on its own (offset) uptime clock. One in five drones does not report its location, so its position has
+// to be estimated from RSSI. The records are generated up front; only the fusion (including JSON formatting, written
+// to /dev/null) is timed.
+//
+// The Location timestamps either advance with every transmission, are all unknown (0xFFFF) or stay frozen at their
+// first value, as some broadcasters send them. Without a timestamp to pair receptions by, the scanner clocks cannot be
+// aligned, so the unknown timestamp stream is generated with already aligned clocks. Every transmission received by
+// any scanner has to come out as exactly one fused report, otherwise the benchmark fails.
+
+#define BENCH_SITE_LAT 42.36
+#define BENCH_SITE_LON -71.09
+#define BENCH_SCANNER_SPACING_M 400.0
+#define BENCH_RANGE_M 1500.0  // scanners further away than this never receive the drone
+#define BENCH_RX_PROBABILITY 0.9
+#define BENCH_RSSI_NOISE_DB 3.0
+#define BENCH_INTERVAL_MS 100
+
+enum BENCH_TIMESTAMPS {
+	BENCH_TIMESTAMPS_ADVANCING = 0,
+	BENCH_TIMESTAMPS_UNKNOWN = 1,
+	BENCH_TIMESTAMPS_FROZEN = 2
+};
+static const char* const BENCH_TIMESTAMPS_STRING[] = {
+	[BENCH_TIMESTAMPS_ADVANCING] = "advancing",
+	[BENCH_TIMESTAMPS_UNKNOWN] = "unknown",
+	[BENCH_TIMESTAMPS_FROZEN] = "frozen"
+};
+
+typedef struct {
+	double center_x;  // m east of the site
+	double center_y;  // m north of the site
+	double radius;  // m
+	double angular_speed;  // rad/s
+	bool hidden;  // does not report its location
+} bench_drone_t;
+
+typedef struct {
+	int n_drones;
+	const bench_drone_t* drones;
+	double cos_site_lat;
+	double error_sum;  // RSSI position error of hidden drones, m
+	uint64_t error_count;
+	uint64_t reports;
+} bench_result_t;
+
+static uint64_t bench_rng = 88172645463325252ull;
+
+
+static double bench_uniform(void) {
+	// xorshift64
+	bench_rng ^= bench_rng << 13;
+	bench_rng ^= bench_rng >> 7;
+	bench_rng ^= bench_rng << 17;
+	return (bench_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+
+static double bench_gaussian(void) {
+	// Box-Muller
+	double u = bench_uniform();
+	double v = bench_uniform();
+	return sqrt(-2.0 * log(u + 1e-300)) * cos(2.0 * M_PI * v);
+}
+
+
+static void bench_drone_position(const bench_drone_t* drone, int64_t t_ms, double* x, double* y) {
+	double angle = drone->angular_speed * t_ms / 1000.0;
+	*x = drone->center_x + drone->radius * cos(angle);
+	*y = drone->center_y + drone->radius * sin(angle);
+}
+
+
+static void bench_on_report(void* ctx, const uas_t* uas, enum POSITION_SOURCE source, double lat, double lon) {
+	bench_result_t* result = ctx;
+	int index;
+
+	result->reports++;
+	if (source != POSITION_RSSI || sscanf((const char*) uas->key, "BENCH%d", &index) != 1 || index >= result->n_drones) {
+		return;
+	}
+	double x;
+	double y;
+	bench_drone_position(&result->drones[index], uas->group_start_ms, &x, &y);  // drone clock == scanner 0 clock
+	double dx = (lon - BENCH_SITE_LON) * METERS_PER_DEG * result->cos_site_lat - x;
+	double dy = (lat - BENCH_SITE_LAT) * METERS_PER_DEG - y;
+	result->error_sum += sqrt(dx * dx + dy * dy);
+	result->error_count++;
+}
+
+
+static int run_bench(fusion_t* fusion, int n_drones, int n_scanners, int seconds, enum BENCH_TIMESTAMPS timestamps) {
+	double cos_site_lat = cos(BENCH_SITE_LAT * M_PI / 180.0);
+	int grid = (int) ceil(sqrt(n_scanners));
+	double scanner_x[MAX_SCANNERS];
+	double scanner_y[MAX_SCANNERS];
+	double clock_offset[MAX_SCANNERS];
+
+	// scanners on a grid centered on the site, each booted at a different time
+	fusion->n_scanners = n_scanners;
+	for (int s=0; s<n_scanners; s++) {
+		scanner_x[s] = (s % grid - (grid - 1) / 2.0) * BENCH_SCANNER_SPACING_M;
+		scanner_y[s] = (s / grid - (grid - 1) / 2.0) * BENCH_SCANNER_SPACING_M;
+		clock_offset[s] = s == 0 || timestamps == BENCH_TIMESTAMPS_UNKNOWN ? 0.0 : bench_uniform() * 3600000.0;
+		fusion->scanners[s].has_position = true;
+		fusion->scanners[s].lat = BENCH_SITE_LAT + scanner_y[s] / METERS_PER_DEG;
+		fusion->scanners[s].lon = BENCH_SITE_LON + scanner_x[s] / (METERS_PER_DEG * cos_site_lat);
+	}
+
+	bench_drone_t* drones = calloc(n_drones, sizeof(*drones));
+	for (int d=0; d<n_drones; d++) {
+		drones[d].center_x = (bench_uniform() - 0.5) * grid * BENCH_SCANNER_SPACING_M;
+		drones[d].center_y = (bench_uniform() - 0.5) * grid * BENCH_SCANNER_SPACING_M;
+		drones[d].radius = 50.0 + bench_uniform() * 200.0;
+		drones[d].angular_speed = 10.0 / drones[d].radius;  // 10 m/s
+		drones[d].hidden = d % 5 == 0;
+	}
+
+	size_t max_records = (size_t) n_drones * n_scanners * (seconds * 1000 / BENCH_INTERVAL_MS);
+	rid_detection_t* records = malloc(max_records * sizeof(*records));
+	int* record_scanner = malloc(max_records * sizeof(*record_scanner));
+	size_t n_records = 0;
+	uint64_t n_transmissions = 0;  // received by at least one scanner
+	if (drones == NULL || records == NULL || record_scanner == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+
+	for (int64_t t_ms=0; t_ms<seconds * 1000; t_ms+=BENCH_INTERVAL_MS) {
+		for (int d=0; d<n_drones; d++) {
+			double x;
+			double y;
+			bench_drone_position(&drones[d], t_ms, &x, &y);
+
+			rid_detection_t det = {
+				.magic = RID_DETECTION_MAGIC,
+				.version = RID_DETECTION_VERSION,
+				.len = sizeof(det),
+				.source = RID_SOURCE_WIFI,
+				.mac = { 0x02, 0xBE, 0x4C, d >> 16, d >> 8, d },
+				.msg_flags = RID_MSG_BASIC_ID | RID_MSG_LOCATION_VECTOR,
+				.id_type = 1,  // serial number
+				.speed_cms = 1000,
+				.geodetic_altitude_m = 100,
+				.timestamp = (t_ms / 100) % ODID_TIMESTAMPS_PER_HOUR,
+			};
+			if (timestamps == BENCH_TIMESTAMPS_UNKNOWN) {
+				det.timestamp = 0xFFFF;
+			} else if (timestamps == BENCH_TIMESTAMPS_FROZEN) {
+				det.timestamp = 1234;
+			}
+			snprintf((char*) det.uas_id, sizeof(det.uas_id), "BENCH%06d", d);
+			if (!drones[d].hidden) {
+				det.lat = (BENCH_SITE_LAT + y / METERS_PER_DEG) * 1e7;
+				det.lon = (BENCH_SITE_LON + x / (METERS_PER_DEG * cos_site_lat)) * 1e7;
+			}
+
+			size_t first_record = n_records;
+			for (int s=0; s<n_scanners; s++) {
+				double dx = x - scanner_x[s];
+				double dy = y - scanner_y[s];
+				double range = sqrt(dx * dx + dy * dy + 100.0 * 100.0);
+				if (range > BENCH_RANGE_M || bench_uniform() > BENCH_RX_PROBABILITY) {
+					continue;
+				}
+				det.rssi = PATH_LOSS_RSSI_1M - 10.0 * PATH_LOSS_EXPONENT * log10(range) + BENCH_RSSI_NOISE_DB * bench_gaussian();
+				det.rssi_filtered = det.rssi;
+				det.rx_uptime_ms = t_ms + clock_offset[s] + bench_uniform() * 20.0;
+				records[n_records] = det;
+				record_scanner[n_records++] = s;
+			}
+			n_transmissions += n_records > first_record;
+		}
+	}
+
+	bench_result_t result = { .n_drones = n_drones, .drones = drones, .cos_site_lat = cos_site_lat };
+	fusion->out = fopen("/dev/null", "w");
+	fusion->report_cb = bench_on_report;
+	fusion->report_ctx = &result;
+
+	struct timespec start;
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (size_t i=0; i<n_records; i++) {
+		fusion_ingest(fusion, record_scanner[i], &records[i]);
+	}
+	fusion_flush(fusion);
+	fflush(fusion->out);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	fusion_print_stats(fusion, elapsed);
+	fprintf(stderr, "%.0f ns/detection, %llu fused reports of %llu transmissions (%s timestamps)\n",
+		elapsed * 1e9 / n_records, (unsigned long long) result.reports, (unsigned long long) n_transmissions,
+		BENCH_TIMESTAMPS_STRING[timestamps]);
+
+	double worst_offset_error = 0.0;
+	for (int s=1; s<n_scanners; s++) {
+		double error = fabs(fusion->scanners[s].clock_offset_ms + clock_offset[s]);
+		if (fusion->scanners[s].clock_anchored && error > worst_offset_error) {
+			worst_offset_error = error;
+		}
+	}
+	fprintf(stderr, "worst clock offset error: %.1f ms\n", worst_offset_error);
+	if (result.error_count > 0) {
+		fprintf(stderr, "mean RSSI position error: %.1f m (%llu reports)\n", result.error_sum / result.error_count,
+			(unsigned long long) result.error_count);
+	}
+
+	free(records);
+	free(record_scanner);
+	free(drones);
+	return result.reports == n_transmissions ? 0 : 1;
+}
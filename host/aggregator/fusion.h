@@ -0,0 +1,486 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "detection.h"
+
+
+// Fusion of detection streams from several scanners.
+//
+// Detections of the same transmission (same UAS, received within FUSION_MATCH_MS of each other on the common time
+// base, and not carrying different ODID Location timestamps) by different scanners are merged into one fused report.
+// Pairs of receptions with the same known timestamp are also used to estimate the offset between the scanners' local
+// uptime clocks, so every report gets a receive time on a common (scanner 0) time base; until a scanner is aligned,
+// the timestamp alone decides. When a report carries no usable self-reported location, or its track is flagged as
+// suspect, the transmitter position is estimated from the RSSI seen by the scanners with known positions.
+
+#define MAX_SCANNERS 32
+#define MAX_UAS (1 << 16)  // must be a power of 2
+#define FUSION_WINDOW_MS 500  // receptions of one transmission arriving later than this (aligned) are not merged
+#define FUSION_MATCH_MS 40  // receptions of one transmission differ less than this (aligned), well below 100 ms sends
+#define FUSION_SWEEP_MS 100  // how often open groups are checked against FUSION_WINDOW_MS
+#define CLOCK_OFFSET_ALPHA 0.05  // EWMA weight of a new clock offset sample
+#define ODID_TIMESTAMPS_PER_HOUR 36000  // Location timestamps are 1/10 s since the hour, anything above is unknown
+
+// log-distance path loss model used to turn RSSI into range
+#define PATH_LOSS_RSSI_1M -40.0  // dBm at 1 m
+#define PATH_LOSS_EXPONENT 2.5
+
+#define METERS_PER_DEG 111320.0
+
+enum POSITION_SOURCE {
+	POSITION_NONE = 0,
+	POSITION_SELF_REPORTED = 1,
+	POSITION_RSSI = 2
+};
+static const char* const POSITION_SOURCE_STRING[] = {
+	[POSITION_NONE] = "none",
+	[POSITION_SELF_REPORTED] = "self",
+	[POSITION_RSSI] = "rssi"
+};
+
+typedef struct {
+	bool has_position;
+	double lat;  // deg
+	double lon;  // deg
+
+	// offset added to this scanner's uptime to get the common time base
+	bool clock_anchored;
+	double clock_offset_ms;
+
+	uint64_t detections;
+	uint64_t bad_records;
+	uint64_t batches;  // UDP export datagrams received
+	uint64_t lost_batches;  // gaps in the export datagram sequence numbers
+} scanner_t;
+
+typedef struct {
+	uint8_t scanner;
+	int8_t rssi;
+	uint32_t rx_uptime_ms;  // receive time on the scanner's own clock
+	int64_t rx_ms;  // aligned receive time
+} observation_t;
+
+typedef struct {
+	bool in_use;
+	uint8_t key[20];  // UAS ID, or the transmitter MAC when no Basic ID has been received
+
+	// currently open group of receptions of one transmission
+	bool group_open;
+	uint16_t group_timestamp;  // ODID Location timestamp of the group
+	int64_t group_start_ms;  // aligned receive time of the first reception
+	rid_detection_t group_detection;  // payload of the first reception
+	uint8_t group_track_flags;  // OR of all receptions
+	int n_obs;
+	observation_t obs[MAX_SCANNERS];
+
+	uint64_t fused;
+	uint64_t duplicates;
+} uas_t;
+
+// transmitter MAC -> UAS, learned from frames that carry a Basic ID, so frames without one (e.g. single Location
+// messages over Bluetooth) are merged into the right UAS
+typedef struct {
+	bool in_use;
+	uint8_t mac[6];
+	uas_t* uas;
+} alias_t;
+
+typedef struct {
+	scanner_t scanners[MAX_SCANNERS];
+	int n_scanners;
+
+	uas_t uas[MAX_UAS];
+	int n_uas;
+	alias_t aliases[MAX_UAS];
+	int n_aliases;
+
+	int64_t now_ms;  // latest aligned receive time seen, drives the window sweeps
+	int64_t last_sweep_ms;
+
+	FILE* out;  // JSON lines, may be NULL
+	void (*report_cb)(void* ctx, const uas_t* uas, enum POSITION_SOURCE source, double lat, double lon);  // optional
+	void* report_ctx;
+
+	uint64_t detections;
+	uint64_t fused;
+	uint64_t duplicates;
+	uint64_t late;  // receptions of a transmission whose group was already emitted
+	uint64_t table_full;
+	uint64_t rssi_positions;
+} fusion_t;
+
+
+static uint32_t uas_hash(const uint8_t* key) {
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (int i=0; i<20; i++) {
+		hash = (hash ^ key[i]) * 16777619u;
+	}
+	return hash;
+}
+
+
+static alias_t* alias_lookup(fusion_t* fusion, const uint8_t* mac, bool create) {
+	uint8_t key[20] = {0};
+	memcpy(key, mac, 6);
+	uint32_t slot = uas_hash(key) & (MAX_UAS - 1);
+
+	for (int probe=0; probe<MAX_UAS; probe++) {
+		alias_t* alias = &fusion->aliases[(slot + probe) & (MAX_UAS - 1)];
+		if (!alias->in_use) {
+			if (!create || fusion->n_aliases >= MAX_UAS / 2) {
+				return NULL;
+			}
+			alias->in_use = true;
+			memcpy(alias->mac, mac, sizeof(alias->mac));
+			fusion->n_aliases++;
+			return alias;
+		}
+		if (memcmp(alias->mac, mac, sizeof(alias->mac)) == 0) {
+			return alias;
+		}
+	}
+	return NULL;
+}
+
+
+static uas_t* uas_lookup(fusion_t* fusion, const uint8_t* key) {
+	uint32_t slot = uas_hash(key) & (MAX_UAS - 1);
+
+	for (int probe=0; probe<MAX_UAS; probe++) {
+		uas_t* uas = &fusion->uas[(slot + probe) & (MAX_UAS - 1)];
+		if (!uas->in_use) {
+			if (fusion->n_uas >= MAX_UAS / 2) {  // keep the probe sequences short
+				return NULL;
+			}
+			uas->in_use = true;
+			memcpy(uas->key, key, sizeof(uas->key));
+			fusion->n_uas++;
+			return uas;
+		}
+		if (memcmp(uas->key, key, sizeof(uas->key)) == 0) {
+			return uas;
+		}
+	}
+	return NULL;
+}
+
+
+static void clock_offset_sample(scanner_t* scanner, double sample) {
+	if (!scanner->clock_anchored) {
+		scanner->clock_offset_ms = sample;
+		scanner->clock_anchored = true;
+	} else {
+		scanner->clock_offset_ms += CLOCK_OFFSET_ALPHA * (sample - scanner->clock_offset_ms);
+	}
+}
+
+
+static void update_clock_offset(fusion_t* fusion, const observation_t* first, int scanner, uint32_t rx_uptime_ms) {
+	/*
+	 Two scanners received the same transmission, so their aligned receive times should be equal. Scanner 0 is the
+	 reference; every other scanner gets its offset from receptions shared with an already anchored scanner.
+	 */
+	scanner_t* a = &fusion->scanners[first->scanner];
+	scanner_t* b = &fusion->scanners[scanner];
+
+	if (a->clock_anchored && scanner != 0) {
+		clock_offset_sample(b, a->clock_offset_ms + first->rx_uptime_ms - (double) rx_uptime_ms);
+	} else if (b->clock_anchored && first->scanner != 0) {
+		clock_offset_sample(a, b->clock_offset_ms + rx_uptime_ms - (double) first->rx_uptime_ms);
+	}
+}
+
+
+static double range_from_rssi(double rssi) {
+	return pow(10.0, (PATH_LOSS_RSSI_1M - rssi) / (10.0 * PATH_LOSS_EXPONENT));
+}
+
+
+static bool estimate_position(const fusion_t* fusion, const uas_t* uas, double* lat, double* lon) {
+	/*
+	 Multilaterate the transmitter from RSSI ranges in a local east/north frame around the first scanner with a known
+	 position. Starts at the RSSI weighted centroid and refines it with a few Gauss-Newton steps when at least 3
+	 scanners are available.
+	 */
+	double x[MAX_SCANNERS];
+	double y[MAX_SCANNERS];
+	double r[MAX_SCANNERS];
+	int n = 0;
+	double lat0 = 0.0;
+	double lon0 = 0.0;
+	double cos_lat0 = 1.0;
+
+	for (int i=0; i<uas->n_obs; i++) {
+		const scanner_t* scanner = &fusion->scanners[uas->obs[i].scanner];
+		if (!scanner->has_position) {
+			continue;
+		}
+		if (n == 0) {
+			lat0 = scanner->lat;
+			lon0 = scanner->lon;
+			cos_lat0 = cos(lat0 * M_PI / 180.0);
+		}
+		x[n] = (scanner->lon - lon0) * METERS_PER_DEG * cos_lat0;
+		y[n] = (scanner->lat - lat0) * METERS_PER_DEG;
+		r[n] = range_from_rssi(uas->obs[i].rssi);
+		n++;
+	}
+	if (n == 0) {
+		return false;
+	}
+
+	double px = 0.0;
+	double py = 0.0;
+	double weight_sum = 0.0;
+	for (int i=0; i<n; i++) {
+		double w = 1.0 / (r[i] * r[i]);
+		px += w * x[i];
+		py += w * y[i];
+		weight_sum += w;
+	}
+	px /= weight_sum;
+	py /= weight_sum;
+
+	for (int iter=0; n >= 3 && iter<5; iter++) {
+		// normal equations of the range residuals, weighted by 1/r^2 since RSSI range error grows with range
+		double a11 = 0.0, a12 = 0.0, a22 = 0.0, b1 = 0.0, b2 = 0.0;
+		for (int i=0; i<n; i++) {
+			double dx = px - x[i];
+			double dy = py - y[i];
+			double d = sqrt(dx * dx + dy * dy);
+			if (d < 1e-3) {
+				d = 1e-3;
+			}
+			double ux = dx / d;
+			double uy = dy / d;
+			double w = 1.0 / (r[i] * r[i]);
+			double residual = r[i] - d;
+			a11 += w * ux * ux;
+			a12 += w * ux * uy;
+			a22 += w * uy * uy;
+			b1 += w * ux * residual;
+			b2 += w * uy * residual;
+		}
+		double det = a11 * a22 - a12 * a12;
+		if (fabs(det) < 1e-12) {
+			break;
+		}
+		px += (a22 * b1 - a12 * b2) / det;
+		py += (a11 * b2 - a12 * b1) / det;
+	}
+
+	*lat = lat0 + py / METERS_PER_DEG;
+	*lon = lon0 + px / (METERS_PER_DEG * cos_lat0);
+	return true;
+}
+
+
+static void print_uas_id(FILE* out, const uint8_t* key) {
+	bool printable = true;
+	int len = 20;
+	while (len > 0 && key[len - 1] == 0) {
+		len--;
+	}
+	for (int i=0; i<len; i++) {
+		if (key[i] < 0x20 || key[i] > 0x7E || key[i] == '"' || key[i] == '\\') {
+			printable = false;
+		}
+	}
+	for (int i=0; i<len; i++) {
+		if (printable) {
+			fputc(key[i], out);
+		} else {
+			fprintf(out, "%02X", key[i]);
+		}
+	}
+}
+
+
+static void emit_group(fusion_t* fusion, uas_t* uas) {
+	/*
+	 Write the fused report of the open group of a UAS as one JSON line.
+	 */
+	const rid_detection_t* det = &uas->group_detection;
+	enum POSITION_SOURCE position_source = POSITION_NONE;
+	double lat = 0.0;
+	double lon = 0.0;
+
+	bool self_reported = (det->msg_flags & RID_MSG_LOCATION_VECTOR) && !(det->lat == 0 && det->lon == 0);
+	if (self_reported && !(uas->group_track_flags & TRACK_FLAG_SUSPECT)) {
+		position_source = POSITION_SELF_REPORTED;
+		lat = det->lat / 1e7;
+		lon = det->lon / 1e7;
+	} else if (estimate_position(fusion, uas, &lat, &lon)) {
+		position_source = POSITION_RSSI;
+		fusion->rssi_positions++;
+	}
+
+	if (fusion->out != NULL) {
+		fputs("{\"uas_id\":\"", fusion->out);
+		print_uas_id(fusion->out, uas->key);
+		fprintf(fusion->out, "\",\"t_ms\":%lld,\"odid_ts\":%u,\"pos\":\"%s\",\"lat\":%.7f,\"lon\":%.7f,\"alt\":%d,"
+			"\"speed\":%.2f,\"heading\":%u,\"flags\":%u,\"rx\":[",
+			(long long) uas->group_start_ms, uas->group_timestamp, POSITION_SOURCE_STRING[position_source], lat, lon,
+			det->geodetic_altitude_m, det->speed_cms / 100.0, det->track_direction, uas->group_track_flags);
+		for (int i=0; i<uas->n_obs; i++) {
+			fprintf(fusion->out, "%s[%u,%d]", i ? "," : "", uas->obs[i].scanner, uas->obs[i].rssi);
+		}
+		fputs("]}\n", fusion->out);
+	}
+
+	if (fusion->report_cb != NULL) {
+		fusion->report_cb(fusion->report_ctx, uas, position_source, lat, lon);
+	}
+
+	uas->group_open = false;
+	uas->fused++;
+	fusion->fused++;
+}
+
+
+static void fusion_sweep(fusion_t* fusion) {
+	/*
+	 Emit every group whose merge window has passed. O(MAX_UAS), but only runs every FUSION_SWEEP_MS of stream time.
+	 */
+	for (int i=0; i<MAX_UAS; i++) {
+		uas_t* uas = &fusion->uas[i];
+		if (uas->in_use && uas->group_open && fusion->now_ms - uas->group_start_ms > FUSION_WINDOW_MS) {
+			emit_group(fusion, uas);
+		}
+	}
+	fusion->last_sweep_ms = fusion->now_ms;
+}
+
+
+static bool same_transmission(const uas_t* uas, const rid_detection_t* det, int64_t rx_ms, bool timestamp_only) {
+	/*
+	 Whether a reception belongs to the (open or last) group of a UAS. Known Location timestamps must match, but as
+	 broadcasters may send the unknown timestamp or never advance it, the aligned receive time decides; only for a
+	 scanner whose clock is not aligned yet is a matching timestamp enough.
+	 */
+	bool keyed = uas->group_timestamp < ODID_TIMESTAMPS_PER_HOUR && det->timestamp < ODID_TIMESTAMPS_PER_HOUR;
+
+	if (keyed && uas->group_timestamp != det->timestamp) {
+		return false;
+	}
+	return (keyed && timestamp_only) || llabs(rx_ms - uas->group_start_ms) <= FUSION_MATCH_MS;
+}
+
+
+static void fusion_ingest(fusion_t* fusion, int scanner, const rid_detection_t* det) {
+	/*
+	 Feed one detection record received from a scanner.
+	 */
+	scanner_t* s = &fusion->scanners[scanner];
+	uint8_t key[20];
+
+	s->detections++;
+	fusion->detections++;
+
+	uas_t* uas = NULL;
+	memset(key, 0, sizeof(key));
+	if (det->msg_flags & RID_MSG_BASIC_ID) {
+		memcpy(key, det->uas_id, sizeof(det->uas_id));
+		uas = uas_lookup(fusion, key);
+		alias_t* alias = alias_lookup(fusion, det->mac, true);
+		if (alias != NULL) {
+			alias->uas = uas;
+		}
+	} else {
+		alias_t* alias = alias_lookup(fusion, det->mac, false);
+		if (alias != NULL) {
+			uas = alias->uas;
+		} else {
+			memcpy(key, det->mac, sizeof(det->mac));
+			uas = uas_lookup(fusion, key);
+		}
+	}
+	if (uas == NULL) {
+		fusion->table_full++;
+		return;
+	}
+	if (!(det->msg_flags & RID_MSG_LOCATION_VECTOR)) {
+		return;  // nothing to fuse, only the identity was learned
+	}
+
+	int64_t rx_ms = det->rx_uptime_ms + (int64_t) s->clock_offset_ms;
+	if (s->clock_anchored && rx_ms > fusion->now_ms) {
+		fusion->now_ms = rx_ms;
+	}
+	if (fusion->now_ms - fusion->last_sweep_ms > FUSION_SWEEP_MS) {
+		fusion_sweep(fusion);
+	}
+
+	if (uas->group_open && same_transmission(uas, det, rx_ms, !s->clock_anchored)) {
+		// another reception of the same transmission
+		for (int i=0; i<uas->n_obs; i++) {
+			if (uas->obs[i].scanner == scanner) {
+				uas->duplicates++;
+				fusion->duplicates++;
+				return;
+			}
+		}
+		if (uas->group_timestamp == det->timestamp && det->timestamp < ODID_TIMESTAMPS_PER_HOUR) {
+			// only a shared timestamp tells the clocks apart, matching by receive time would just confirm the offset
+			update_clock_offset(fusion, &uas->obs[0], scanner, det->rx_uptime_ms);
+			rx_ms = det->rx_uptime_ms + (int64_t) s->clock_offset_ms;
+		}
+		uas->obs[uas->n_obs++] = (observation_t) {
+			.scanner = scanner, .rssi = det->rssi_filtered, .rx_uptime_ms = det->rx_uptime_ms, .rx_ms = rx_ms
+		};
+		uas->group_track_flags |= det->track_flags;
+		return;
+	}
+
+	if (!uas->group_open && uas->fused > 0 && same_transmission(uas, det, rx_ms, false)) {
+		fusion->late++;
+		return;
+	}
+
+	// first reception of a new transmission
+	if (uas->group_open) {
+		emit_group(fusion, uas);
+	}
+	uas->group_open = true;
+	uas->group_timestamp = det->timestamp;
+	uas->group_start_ms = rx_ms;
+	uas->group_detection = *det;
+	uas->group_track_flags = det->track_flags;
+	uas->n_obs = 1;
+	uas->obs[0] = (observation_t) {
+		.scanner = scanner, .rssi = det->rssi_filtered, .rx_uptime_ms = det->rx_uptime_ms, .rx_ms = rx_ms
+	};
+}
+
+
+static void fusion_flush(fusion_t* fusion) {
+	for (int i=0; i<MAX_UAS; i++) {
+		if (fusion->uas[i].in_use && fusion->uas[i].group_open) {
+			emit_group(fusion, &fusion->uas[i]);
+		}
+	}
+}
+
+
+static void fusion_print_stats(const fusion_t* fusion, double seconds) {
+	fprintf(stderr, "detections: %llu  fused: %llu  duplicates: %llu  late: %llu  rssi positions: %llu  table full: %llu\n",
+		(unsigned long long) fusion->detections, (unsigned long long) fusion->fused,
+		(unsigned long long) fusion->duplicates, (unsigned long long) fusion->late,
+		(unsigned long long) fusion->rssi_positions, (unsigned long long) fusion->table_full);
+	for (int i=0; i<fusion->n_scanners; i++) {
+		const scanner_t* s = &fusion->scanners[i];
+		fprintf(stderr, "scanner %d: detections: %llu  bad records: %llu  batches: %llu  lost batches: %llu  "
+			"clock offset: %.1f ms%s\n", i,
+			(unsigned long long) s->detections, (unsigned long long) s->bad_records,
+			(unsigned long long) s->batches, (unsigned long long) s->lost_batches, s->clock_offset_ms,
+			s->clock_anchored ? "" : " (not aligned)");
+	}
+	if (seconds > 0.0) {
+		fprintf(stderr, "%.0f detections/s\n", fusion->detections / seconds);
+	}
+}
@@ -0,0 +1,277 @@
+#include <stddef.h>
+#include <signal.h>
+#include <sys/stat.h>
+
+
+// Detection record inputs: recorded captures (merged by time), live byte streams (serial devices, pipes) and UDP.
+
+#define STREAM_BUFFER_SIZE 4096
+#define RECORD_MIN_LEN offsetof(rid_detection_t, rssi_filtered)  // version 1 records end after system_timestamp
+
+typedef struct {
+	int fd;
+	int scanner;
+	uint8_t buf[STREAM_BUFFER_SIZE];
+	size_t start;
+	size_t end;
+	bool eof;
+	bool live;  // serial device or pipe, read in arrival order instead of replayed
+
+	// replay only: next record of this capture and the capture's first receive time
+	bool pending;
+	rid_detection_t det;
+	bool has_base;
+	uint32_t base_ms;
+} stream_t;
+
+static volatile sig_atomic_t stop_requested;
+
+
+static void on_signal(int sig) {
+	(void) sig;
+	stop_requested = 1;
+}
+
+
+static bool next_record(stream_t* stream, scanner_t* scanner, rid_detection_t* det) {
+	/*
+	 Extract the next complete record from the buffered bytes of a stream, resynchronizing on the magic byte after
+	 garbage. Every record version only appended fields: fields a record is too old to have are zero, except the
+	 filtered RSSI (version 2), which falls back to the raw RSSI, and the data age (version 4), which is unknown.
+	 Returns false when more bytes are needed.
+	 */
+	while (stream->end - stream->start >= 3) {
+		const uint8_t* p = &stream->buf[stream->start];
+		if (p[0] == RID_DETECTION_MAGIC && p[1] >= 1 && p[2] >= RECORD_MIN_LEN) {
+			if (stream->end - stream->start < p[2]) {
+				return false;
+			}
+			memset(det, 0, sizeof(*det));
+			memcpy(det, p, p[2] < sizeof(*det) ? p[2] : sizeof(*det));
+			if (det->version < 2) {
+				det->rssi_filtered = det->rssi;
+			}
+			if (det->version < 4) {
+				det->data_age_ms = RID_DATA_AGE_UNKNOWN;
+			}
+			stream->start += p[2];
+			return true;
+		}
+		stream->start++;
+		scanner->bad_records++;
+	}
+	return false;
+}
+
+
+static bool fill_stream(stream_t* stream) {
+	/*
+	 Read more bytes into the stream buffer. Returns false at end of file or on error.
+	 */
+	if (stream->start > 0) {
+		memmove(stream->buf, &stream->buf[stream->start], stream->end - stream->start);
+		stream->end -= stream->start;
+		stream->start = 0;
+	}
+	ssize_t n = read(stream->fd, &stream->buf[stream->end], sizeof(stream->buf) - stream->end);
+	if (n <= 0) {
+		if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+			return true;
+		}
+		stream->eof = true;
+		return false;
+	}
+	stream->end += n;
+	return true;
+}
+
+
+static stream_t streams[MAX_SCANNERS];
+
+
+static int open_streams(fusion_t* fusion, const char* const* paths, int n_paths) {
+	/*
+	 Open the -f inputs, one scanner each. Regular files are recorded captures and get replayed; anything else
+	 (serial devices, pipes) is read live.
+	 */
+	for (int i=0; i<n_paths; i++) {
+		stream_t* stream = &streams[i];
+		stream->fd = open(paths[i], O_RDONLY);
+		stream->scanner = i;
+		if (stream->fd < 0) {
+			fprintf(stderr, "%s: %s\n", paths[i], strerror(errno));
+			return -1;
+		}
+		struct stat st;
+		stream->live = fstat(stream->fd, &st) == 0 && !S_ISREG(st.st_mode);
+	}
+	if (fusion->n_scanners < n_paths) {
+		fusion->n_scanners = n_paths;
+	}
+	return 0;
+}
+
+
+static void replay_streams(fusion_t* fusion, int n_streams) {
+	/*
+	 Replay the recorded captures merged by receive time relative to the start of each capture (the captures are
+	 assumed to have been started together; the fusion clock alignment takes care of the rest).
+	 */
+	while (1) {
+		stream_t* oldest = NULL;
+		for (int i=0; i<n_streams; i++) {
+			stream_t* stream = &streams[i];
+			while (!stream->live && !stream->pending && !stream->eof) {
+				if (next_record(stream, &fusion->scanners[i], &stream->det)) {
+					stream->pending = true;
+					if (!stream->has_base) {
+						stream->has_base = true;
+						stream->base_ms = stream->det.rx_uptime_ms;
+					}
+				} else {
+					fill_stream(stream);
+				}
+			}
+			if (stream->pending && (oldest == NULL ||
+			    stream->det.rx_uptime_ms - stream->base_ms < oldest->det.rx_uptime_ms - oldest->base_ms)) {
+				oldest = stream;
+			}
+		}
+		if (oldest == NULL) {
+			return;
+		}
+		fusion_ingest(fusion, oldest->scanner, &oldest->det);
+		oldest->pending = false;
+	}
+}
+
+
+static int open_udp(int port) {
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port), .sin_addr.s_addr = htonl(INADDR_ANY) };
+	if (fd < 0 || bind(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0) {
+		fprintf(stderr, "udp port %d: %s\n", port, strerror(errno));
+		return -1;
+	}
+	int rcvbuf = 4 << 20;  // ride out bursts while the JSON output blocks
+	setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+	return fd;
+}
+
+
+static void receive_udp(fusion_t* fusion, int fd) {
+	/*
+	 Ingest one datagram. Every datagram holds one or more whole records; each sender address is a separate scanner.
+	 */
+	static struct sockaddr_in senders[MAX_SCANNERS];
+	static int sender_scanner[MAX_SCANNERS];
+	static bool sender_has_seq[MAX_SCANNERS];
+	static uint32_t sender_seq[MAX_SCANNERS];
+	static int n_senders;
+	static stream_t datagram;
+	struct sockaddr_in from;
+	socklen_t from_len = sizeof(from);
+
+	ssize_t n = recvfrom(fd, datagram.buf, sizeof(datagram.buf), 0, (struct sockaddr*) &from, &from_len);
+	if (n <= 0) {
+		return;
+	}
+
+	int sender = -1;
+	for (int i=0; i<n_senders; i++) {
+		if (senders[i].sin_addr.s_addr == from.sin_addr.s_addr && senders[i].sin_port == from.sin_port) {
+			sender = i;
+		}
+	}
+	if (sender < 0) {
+		if (fusion->n_scanners >= MAX_SCANNERS) {
+			return;
+		}
+		sender = n_senders++;
+		senders[sender] = from;
+		sender_scanner[sender] = fusion->n_scanners++;
+		fprintf(stderr, "scanner %d: %s:%u\n", sender_scanner[sender], inet_ntoa(from.sin_addr), ntohs(from.sin_port));
+	}
+	int scanner = sender_scanner[sender];
+
+	rid_detection_t det;
+	datagram.start = 0;
+	datagram.end = n;
+
+	// batched export datagrams (src/export.h) start with a header whose sequence number reveals lost datagrams
+	if ((size_t) n >= sizeof(rid_batch_header_t) && datagram.buf[0] == RID_BATCH_MAGIC) {
+		rid_batch_header_t header;
+		memcpy(&header, datagram.buf, sizeof(header));
+		if (sender_has_seq[sender] && header.seq - sender_seq[sender] > 1 && header.seq - sender_seq[sender] < (1u << 31)) {
+			fusion->scanners[scanner].lost_batches += header.seq - sender_seq[sender] - 1;
+		}
+		sender_has_seq[sender] = true;
+		sender_seq[sender] = header.seq;
+		fusion->scanners[scanner].batches++;
+		datagram.start = sizeof(header);
+	}
+	while (next_record(&datagram, &fusion->scanners[scanner], &det)) {
+		fusion_ingest(fusion, scanner, &det);
+	}
+}
+
+
+static int run_live(fusion_t* fusion, int n_streams, int udp_port) {
+	/*
+	 Read the live byte streams and the UDP socket (if udp_port >= 0) in arrival order until interrupted.
+	 */
+	struct pollfd fds[MAX_SCANNERS + 1];
+	stream_t* fd_streams[MAX_SCANNERS];
+	int n_fds = 0;
+
+	for (int i=0; i<n_streams; i++) {
+		if (streams[i].live) {
+			fd_streams[n_fds] = &streams[i];
+			fds[n_fds++] = (struct pollfd) { .fd = streams[i].fd, .events = POLLIN };
+		}
+	}
+	int udp_fd = -1;
+	if (udp_port >= 0) {
+		udp_fd = open_udp(udp_port);
+		if (udp_fd < 0) {
+			return -1;
+		}
+		fds[n_fds] = (struct pollfd) { .fd = udp_fd, .events = POLLIN };
+	}
+	if (n_fds == 0 && udp_fd < 0) {
+		return 0;
+	}
+
+	int n_open = n_fds;
+	signal(SIGINT, on_signal);
+	signal(SIGTERM, on_signal);
+	while (!stop_requested && (n_open > 0 || udp_fd >= 0)) {
+		if (poll(fds, n_fds + (udp_fd >= 0), 100) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return -1;
+		}
+		for (int i=0; i<n_fds; i++) {
+			stream_t* stream = fd_streams[i];
+			rid_detection_t det;
+			if (!(fds[i].revents & (POLLIN | POLLHUP))) {
+				continue;
+			}
+			if (!fill_stream(stream)) {
+				fds[i].fd = -1;  // closed, poll ignores negative fds
+				n_open--;
+			}
+			while (next_record(stream, &fusion->scanners[stream->scanner], &det)) {
+				fusion_ingest(fusion, stream->scanner, &det);
+			}
+		}
+		if (udp_fd >= 0 && (fds[n_fds].revents & POLLIN)) {
+			receive_udp(fusion, udp_fd);
+		}
+	}
+	if (udp_fd >= 0) {
+		close(udp_fd);
+	}
+	return 0;
+}
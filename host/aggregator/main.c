@@ -0,0 +1,139 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Host-side aggregator of RID detection streams from several scanners
+ *
+ * Reads the binary detection records (src/detection.h) that every scanner writes to RTT channel 1, from recorded
+ * captures / serial devices (-f) and/or from UDP datagrams (-u), fuses them (fusion.h) and writes one JSON line per
+ * transmission to stdout. Statistics are printed to stderr at exit.
+ *
+ *   rid_aggregator -f scanner0.bin -f scanner1.bin -s 0,42.36,-71.09 -s 1,42.361,-71.088
+ *   rid_aggregator -u 4000
+ *   rid_aggregator -b 200,8,60  (synthetic benchmark: 200 drones, 8 scanners, 60 s of traffic)
+ */
+
+#define _DEFAULT_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fusion.h"
+#include "input.h"
+#include "bench.h"
+
+
+static void usage(const char* prog) {
+	fprintf(stderr,
+		"usage: %s [-f capture]... [-u port] [-s scanner,lat,lon]... [-b drones,scanners,seconds[,timestamps]]\n"
+		"  -f  binary detection capture or serial device of one scanner (scanner index = order of -f)\n"
+		"  -u  listen for detection datagrams on this UDP port (scanner index = order of first datagram per sender)\n"
+		"  -s  position of a scanner, used to estimate transmitter positions from RSSI\n"
+		"  -b  run the synthetic benchmark instead of reading inputs, with advancing (default), unknown or frozen\n"
+		"      Location timestamps\n", prog);
+}
+
+
+int main(int argc, char** argv) {
+	const char* files[MAX_SCANNERS];
+	int n_files = 0;
+	int udp_port = -1;
+	int bench_drones = 0;
+	int bench_scanners = 0;
+	int bench_seconds = 0;
+	enum BENCH_TIMESTAMPS bench_timestamps = BENCH_TIMESTAMPS_ADVANCING;
+
+	fusion_t* fusion = calloc(1, sizeof(*fusion));
+	if (fusion == NULL) {
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	fusion->out = stdout;
+	fusion->scanners[0].clock_anchored = true;  // scanner 0 is the time reference
+
+	int opt;
+	while ((opt = getopt(argc, argv, "f:u:s:b:h")) != -1) {
+		switch (opt) {
+		case 'f':
+			if (n_files >= MAX_SCANNERS) {
+				fprintf(stderr, "at most %d scanners\n", MAX_SCANNERS);
+				return 1;
+			}
+			files[n_files++] = optarg;
+			break;
+		case 'u':
+			udp_port = atoi(optarg);
+			break;
+		case 's': {
+			int index;
+			double lat;
+			double lon;
+			if (sscanf(optarg, "%d,%lf,%lf", &index, &lat, &lon) != 3 || index < 0 || index >= MAX_SCANNERS) {
+				usage(argv[0]);
+				return 1;
+			}
+			fusion->scanners[index].has_position = true;
+			fusion->scanners[index].lat = lat;
+			fusion->scanners[index].lon = lon;
+			break;
+		}
+		case 'b': {
+			char timestamps[16] = "advancing";
+			if (sscanf(optarg, "%d,%d,%d,%15s", &bench_drones, &bench_scanners, &bench_seconds, timestamps) < 3 ||
+			    bench_scanners < 1 || bench_scanners > MAX_SCANNERS) {
+				usage(argv[0]);
+				return 1;
+			}
+			size_t i = 0;
+			while (i < sizeof(BENCH_TIMESTAMPS_STRING) / sizeof(BENCH_TIMESTAMPS_STRING[0]) &&
+			       strcmp(timestamps, BENCH_TIMESTAMPS_STRING[i]) != 0) {
+				i++;
+			}
+			if (i == sizeof(BENCH_TIMESTAMPS_STRING) / sizeof(BENCH_TIMESTAMPS_STRING[0])) {
+				usage(argv[0]);
+				return 1;
+			}
+			bench_timestamps = i;
+			break;
+		}
+		default:
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (bench_drones > 0) {
+		return run_bench(fusion, bench_drones, bench_scanners, bench_seconds, bench_timestamps);
+	}
+	if (n_files == 0 && udp_port < 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	if (open_streams(fusion, files, n_files) != 0) {
+		return 1;
+	}
+	replay_streams(fusion, n_files);
+	if (run_live(fusion, n_files, udp_port) != 0) {
+		return 1;
+	}
+	fusion_flush(fusion);
+	fflush(fusion->out);
+
+	struct timespec end;
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	fusion_print_stats(fusion, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+	return 0;
+}
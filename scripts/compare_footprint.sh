@@ -0,0 +1,63 @@
+#!/bin/sh
+# Build the default and headless variants for one board and print their flash/RAM
+# usage side by side, e.g.:
+#   scripts/compare_footprint.sh nrf7002dk_nrf5340_cpuapp
+#
+# With -t and a DK attached, each variant is also flashed and its boot-to-first-scan
+# time ("First scan done ... ms after boot", logged by the firmware) is read over RTT
+# with JLinkRTTLogger from the nRF Command Line Tools:
+#   scripts/compare_footprint.sh -t nrf7002dk_nrf5340_cpuapp
+
+set -e
+
+BOOT_TIME=0
+if [ "$1" = "-t" ]; then
+	BOOT_TIME=1
+	shift
+fi
+BOARD=${1:-nrf7002dk_nrf5340_cpuapp}
+APP_DIR=$(cd "$(dirname "$0")/.." && pwd)
+RTT_DEVICE=nRF5340_xxAA_APP
+RTT_SECONDS=15  # long enough for the first scan of the default variant to finish
+
+# the linker prints "<region>: <used> B <size> <unit> <percent>" at the end of every build
+west build -p always -b "$BOARD" -d "$APP_DIR/build_default" "$APP_DIR" > "$APP_DIR/build_default.log"
+west build -p always -b "$BOARD" -d "$APP_DIR/build_headless" "$APP_DIR" -- -DHEADLESS=ON > "$APP_DIR/build_headless.log"
+
+used() {
+	awk -v r="$2:" '$1 == r && $3 == "B" { print $2 }' "$1" | tail -n 1
+}
+
+first_scan_ms() {
+	# flash a build and log RTT channel 0 for RTT_SECONDS; the RTT buffer keeps the boot messages until the logger
+	# attaches (it drops, not overwrites, when full)
+	west flash -d "$APP_DIR/$1" > /dev/null
+	rm -f "$APP_DIR/$1_rtt.log"
+	JLinkRTTLogger -Device "$RTT_DEVICE" -If SWD -Speed 4000 -RTTChannel 0 "$APP_DIR/$1_rtt.log" > /dev/null &
+	logger=$!
+	sleep "$RTT_SECONDS"
+	kill "$logger"
+	wait "$logger" || true
+	sed -n 's/.*First scan done \([0-9]*\) ms after boot.*/\1/p' "$APP_DIR/$1_rtt.log" | head -n 1
+}
+
+printf "%-8s %10s %10s %10s\n" region default headless saved
+for region in FLASH RAM; do
+	default=$(used "$APP_DIR/build_default.log" "$region")
+	headless=$(used "$APP_DIR/build_headless.log" "$region")
+	if [ -z "$default" ] || [ -z "$headless" ]; then
+		echo "no $region usage in build_*.log (the board's linker does not report it)" >&2
+		exit 1
+	fi
+	printf "%-8s %10s %10s %10s\n" "$region" "$default" "$headless" "$((default - headless))"
+done
+
+if [ "$BOOT_TIME" = 1 ]; then
+	default=$(first_scan_ms build_default)
+	headless=$(first_scan_ms build_headless)
+	if [ -z "$default" ] || [ -z "$headless" ]; then
+		echo "no \"First scan done\" line within $RTT_SECONDS s, see build_*_rtt.log" >&2
+		exit 1
+	fi
+	printf "%-8s %10s %10s %10s\n" SCAN_MS "$default" "$headless" "$((default - headless))"
+fi
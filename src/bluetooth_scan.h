@@ -8,17 +8,18 @@
 #include <bluetooth/gatt_dm.h>
 #include <bluetooth/scan.h>
 
-static uint8_t bt_scan_finished;
+static uint8_t bt_scan_finished;  // 1 while scanning is stopped
 
 
 static void bluetooth_scan_init(void) {
-	/* Use active scanning and disable duplicate filtering to handle any
-	 * devices that might update their advertising data at runtime. */
+	/* Use passive scanning and disable duplicate filtering, ODID advertisements
+	 * change with every message counter. Both PHYs: Bluetooth 4 legacy
+	 * advertisements are on 1M, Bluetooth 5 long range ones on Coded. */
 	struct bt_le_scan_param scan_param = {
 		.type     = BT_LE_SCAN_TYPE_PASSIVE,
 		.interval = BT_GAP_SCAN_FAST_INTERVAL,
 		.window   = BT_GAP_SCAN_FAST_WINDOW,
-		.options  = BT_LE_SCAN_OPT_CODED | BT_LE_SCAN_OPT_NO_1M
+		.options  = BT_LE_SCAN_OPT_CODED
 	};
 
 	struct bt_scan_init_param scan_init = {
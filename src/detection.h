@@ -0,0 +1,101 @@
+#ifndef DETECTION_H
+#define DETECTION_H
+
+#include <stdint.h>
+
+
+// Machine-readable detection record emitted for every decoded RID frame.
+// Only fixed-width little endian fields (no Zephyr headers) so host-side tools can include this file as-is.
+
+#define RID_DETECTION_MAGIC 0xD7
+#define RID_DETECTION_VERSION 4
+
+// which radio the frame was received on
+enum RID_SOURCE {
+	RID_SOURCE_WIFI = 0,
+	RID_SOURCE_BT = 1
+};
+
+// reference of rid_detection_t.rx_utc_ms, from worst to best
+enum RID_TIME_SOURCE {
+	RID_TIME_NONE = 0,  // no UTC reference yet, rx_utc_ms and data_age_ms are unknown
+	RID_TIME_SYSTEM_MSG = 1,  // ODID System message timestamps (1 s resolution, transmitter clocks)
+	RID_TIME_SNTP = 2
+};
+
+#define RID_DATA_AGE_UNKNOWN INT32_MIN
+
+// bits of rid_detection_t.msg_flags, one per message type found in the pack
+#define RID_MSG_BASIC_ID        (1 << 0)
+#define RID_MSG_LOCATION_VECTOR (1 << 1)
+#define RID_MSG_AUTHENTICATION  (1 << 2)
+#define RID_MSG_SELF_ID         (1 << 3)
+#define RID_MSG_SYSTEM          (1 << 4)
+#define RID_MSG_OPERATOR_ID     (1 << 5)
+
+// bits of rid_detection_t.track_flags
+#define TRACK_FLAG_INCONSISTENT (1 << 0)  // the latest position report failed the consistency gate
+#define TRACK_FLAG_SUSPECT      (1 << 1)  // repeated inconsistent reports, possibly spoofed
+#define TRACK_FLAG_PREDICTED    (1 << 2)  // no Location/Vector message: lat/lon/altitude predicted from the track
+
+typedef struct __attribute__((packed)) {
+	uint8_t magic;  // RID_DETECTION_MAGIC
+	uint8_t version;  // RID_DETECTION_VERSION
+	uint8_t len;  // sizeof(rid_detection_t), so readers can skip records of a newer version
+	uint8_t source;  // enum RID_SOURCE
+
+	uint32_t rx_uptime_ms;  // local uptime when the frame was received
+	uint8_t mac[6];  // transmitter address
+	int8_t rssi;  // dBm
+	uint8_t channel;
+	uint8_t msg_flags;  // RID_MSG_* bits
+
+	uint8_t id_type;  // enum ID_TYPE
+	uint8_t ua_type;  // enum UA_TYPE
+	uint8_t uas_id[20];  // raw ID bytes
+
+	uint8_t op_status;  // enum OPERATIONAL_STATUS
+	uint16_t track_direction;  // deg
+	uint16_t speed_cms;  // ground speed in cm/s
+	int16_t vertical_speed_cms;  // cm/s, positive = up
+	int32_t lat;  // deg * 10^7
+	int32_t lon;  // deg * 10^7
+	int16_t geodetic_altitude_m;
+	int16_t height_m;
+	uint16_t timestamp;  // 1/10ths of seconds since the last hour relative to UTC time
+
+	int32_t operator_lat;  // deg * 10^7
+	int32_t operator_lon;  // deg * 10^7
+	uint32_t system_timestamp;  // seconds since 00:00:00 01/01/2019
+
+	// per-transmitter track state after this frame (see track.h)
+	int8_t rssi_filtered;  // dBm
+	int16_t rssi_trend;  // 0.1 dB/s, positive = getting closer
+	uint8_t track_flags;  // TRACK_FLAG_* bits
+	uint16_t position_error_m;  // distance between the reported and the predicted position, 0 if TRACK_FLAG_PREDICTED
+
+	// reception quality of the transmitter address (see ingest.h)
+	uint8_t msg_counter;  // ODID message counter of the frame
+	uint8_t loss_percent;  // counters missed within the recent receive windows
+	uint16_t rx_interval_ms;  // smoothed time between unique frames, 0 until known
+
+	// absolute time (see timebase.h)
+	uint8_t time_source;  // enum RID_TIME_SOURCE
+	int64_t rx_utc_ms;  // UTC when the frame was received, ms since the Unix epoch (0 if unknown)
+	int32_t data_age_ms;  // rx_utc_ms minus the Location/Vector timestamp, RID_DATA_AGE_UNKNOWN without either
+} rid_detection_t;
+
+
+// UDP export datagrams in the compact binary format: one header followed by `count` detection records
+#define RID_BATCH_MAGIC 0xB7
+#define RID_BATCH_VERSION 1
+
+typedef struct __attribute__((packed)) {
+	uint8_t magic;  // RID_BATCH_MAGIC
+	uint8_t version;  // RID_BATCH_VERSION
+	uint16_t count;  // number of records that follow
+	uint32_t seq;  // incremented per datagram, lets the collector measure loss
+	uint32_t tx_uptime_ms;  // local uptime when the datagram was sent
+} rid_batch_header_t;
+
+#endif
@@ -5,6 +5,7 @@ enum ID_TYPE {
 	UTM_ASSIGNED_UUID = 3, 
 	SPECIFIC_SESSION_ID = 4
 };
+#ifndef HEADLESS
 static const char* const ID_TYPE_STRING[] = {
 	[ID_NONE] = "ID_NONE",
 	[SERIAL_NUMBER_ANSI_CTA_2063_A] = "SERIAL_NUMBER_ANSI_CTA_2063_A",
@@ -12,6 +13,7 @@ static const char* const ID_TYPE_STRING[] = {
 	[UTM_ASSIGNED_UUID] = "UTM_ASSIGNED_UUID",
 	[SPECIFIC_SESSION_ID] = "SPECIFIC_SESSION_ID"
 };
+#endif
 
 enum UA_TYPE {
 	UA_NONE = 0, 
@@ -31,6 +33,7 @@ enum UA_TYPE {
 	GROUND_OBSTACLE = 14, 
 	OTHER = 15
 };
+#ifndef HEADLESS
 static const char* const UA_TYPE_STRING[] = {
 	[UA_NONE] = "UA_NONE",
 	[AEROPLANE] = "AEROPLANE",
@@ -49,6 +52,7 @@ static const char* const UA_TYPE_STRING[] = {
 	[GROUND_OBSTACLE] = "GROUND_OBSTACLE",
 	[OTHER] = "OTHER"
 };
+#endif
 
 enum OPERATIONAL_STATUS {
 	UNDECLARED = 0, 
@@ -57,6 +61,7 @@ enum OPERATIONAL_STATUS {
 	EMERGENCY = 3, 
 	REMOTE_ID_SYSTEM_FAILURE = 4
 };
+#ifndef HEADLESS
 static const char* const OPERATIONAL_STATUS_STRING[] = {
 	[UNDECLARED] = "UNDECLARED",
 	[GROUND] = "GROUND",
@@ -64,34 +69,41 @@ static const char* const OPERATIONAL_STATUS_STRING[] = {
 	[EMERGENCY] = "EMERGENCY",
 	[REMOTE_ID_SYSTEM_FAILURE] = "REMOTE_ID_SYSTEM_FAILURE"
 };
+#endif
 
 
 enum HEIGHT_TYPE {
 	ABOVE_TAKEOFF = 0,
 	AGL = 1
 };
+#ifndef HEADLESS
 static const char* const HEIGHT_TYPE_STRING[] = {
 	[ABOVE_TAKEOFF] = "ABOVE_TAKEOFF",
 	[AGL] = "AGL"  // Above Ground Level
 };
+#endif
 
 enum E_W_DIRECTION_SEGMENT {
 	LESS_THAN_180 = 0,
 	GREATER_THAN_EQUAL_TO_180 = 1
 };
+#ifndef HEADLESS
 static const char* const E_W_DIRECTION_SEGMENT_STRING[] = {
 	[LESS_THAN_180] = "<180",
 	[GREATER_THAN_EQUAL_TO_180] = ">=180"
 };
+#endif
 
 enum SPEED_MULTIPLIER {
 	X_0_25 = 0,
 	X_0_75 = 1
 };
+#ifndef HEADLESS
 static const char* const SPEED_MULTIPLIER_STRING[] = {
 	[X_0_25] = "0.25",
 	[X_0_75] = "0.75"
 };
+#endif
 
 enum VERTICAL_HORIZONTAL_BARO_ALT_ACCURACY {
 	UNKNOWN_GREATER_THAN_150M = 0, 
@@ -102,6 +114,7 @@ enum VERTICAL_HORIZONTAL_BARO_ALT_ACCURACY {
 	LESS_THAN_3M = 5,
 	LESS_THAN_1M = 6
 };
+#ifndef HEADLESS
 static const char* const VERTICAL_HORIZONTAL_BARO_ALT_ACCURACY_STRING[] = {
 	[UNKNOWN_GREATER_THAN_150M] = "UNKNOWN OR >=150 m",
 	[LESS_THAN_150M] = "<150 m",
@@ -111,6 +124,7 @@ static const char* const VERTICAL_HORIZONTAL_BARO_ALT_ACCURACY_STRING[] = {
 	[LESS_THAN_3M] = "<3 m",
 	[LESS_THAN_1M] = "<1 m"
 };
+#endif
 
 enum SPEED_ACCURACY {
 	UNKNOWN_GREATER_THAN_10M_S = 0, 
@@ -119,6 +133,7 @@ enum SPEED_ACCURACY {
 	LESS_THAN_1M_S = 3, 
 	LESS_THAN_0_3M_S = 4
 };
+#ifndef HEADLESS
 static const char* const SPEED_ACCURACY_STRING[] = {
 	[UNKNOWN_GREATER_THAN_10M_S] = "UNKNOWN OR >=10 m/s",
 	[LESS_THAN_10M_S] = "<10 m/s",
@@ -126,28 +141,33 @@ static const char* const SPEED_ACCURACY_STRING[] = {
 	[LESS_THAN_1M_S] = "<1 m/s",
 	[LESS_THAN_0_3M_S] = "<0.3 m/s"
 };
+#endif
 
 enum SELF_ID_TYPE {
 	TEXT_DESCRIPTION = 0, 
 	EMERGENCY_DESCRIPTION = 1, 
 	EXTENDED_STATUS_DESCRIPTION = 2
 };
+#ifndef HEADLESS
 static const char* const SELF_ID_TYPE_STRING[] = {
 	[TEXT_DESCRIPTION] = "TEXT DESCRIPTION",
 	[EMERGENCY_DESCRIPTION] = "EMERGENCY DESCRIPTION",
 	[EXTENDED_STATUS_DESCRIPTION] = "EXTENDED_STATUS DESCRIPTION"
 };
+#endif
 
 enum OPERATOR_LOCATION_ALTITUDE_SOURCE_TYPE {
 	TAKE_OFF = 0, 
 	DYNAMIC = 1, 
 	FIXED = 2
 };
+#ifndef HEADLESS
 static const char* const OPERATOR_LOCATION_ALTITUDE_SOURCE_TYPE_STRING[] = {
 	[TAKE_OFF] = "TAKE OFF",
 	[DYNAMIC] = "DYNAMIC",
 	[FIXED] = "FIXED"
 };
+#endif
 
 enum UA_CATEGORY {
 	UNDEFINED = 0, 
@@ -155,12 +175,14 @@ enum UA_CATEGORY {
 	SPECIFIC = 2,
 	CERTIFIED = 3
 };
+#ifndef HEADLESS
 static const char* const UA_CATEGORY_STRING[] = {
 	[UNDEFINED] = "UNDEFINED",
 	[OPEN] = "OPEN",
 	[SPECIFIC] = "SPECIFIC",
 	[CERTIFIED] = "CERTIFIED"
 };
+#endif
 
 enum UA_CLASS {
 	UNDEFINED_CLASS = 0, 
@@ -172,6 +194,7 @@ enum UA_CLASS {
 	CLASS5 = 6,
 	CLASS6 = 7,
 };
+#ifndef HEADLESS
 static const char* const UA_CLASS_STRING[] = {
 	[UNDEFINED_CLASS] = "UNDEFINED",
 	[CLASS0] = "CLASS 0",
@@ -181,4 +204,5 @@ static const char* const UA_CLASS_STRING[] = {
 	[CLASS4] = "CLASS 4",
 	[CLASS5] = "CLASS 5",
 	[CLASS6] = "CLASS 6"
-};
\ No newline at end of file
+};
+#endif
\ No newline at end of file
@@ -0,0 +1,264 @@
+#ifdef EXPORT
+#include <zephyr/net/socket.h>
+
+#include "detection.h"
+
+
+// Batched UDP export of detection (track update) records to a collector.
+//
+// The scan path only copies records into a queue. The main loop drains the queue between Wi-Fi scans (the radio is
+// shared, so nothing is sent while a scan is in progress) into datagrams of at most EXPORT_MAX_DATAGRAM bytes, either
+// in a Net-RID-like JSON format or in the compact binary format of detection.h. A datagram is sent when it is full or
+// when EXPORT_INTERVAL_MS has passed since the last one.
+
+#define EXPORT_MAX_DATAGRAM 1232  // fits the IPv6 minimum MTU, so datagrams are never fragmented
+#define EXPORT_INTERVAL_MS 1000
+#define EXPORT_QUEUE_DEPTH 128  // records buffered while a scan is in progress
+
+// records that fit into one binary datagram
+#define EXPORT_BINARY_BATCH ((EXPORT_MAX_DATAGRAM - sizeof(rid_batch_header_t)) / sizeof(rid_detection_t))
+
+// records that always fit into one JSON datagram: the longest record (every field at its widest, binary ID) plus
+// its separating comma, after the {"seq":..,"flights":[ ... ]} wrapper
+#define EXPORT_JSON_RECORD_MAX 374
+#define EXPORT_JSON_WRAPPER 32
+#define EXPORT_JSON_BATCH ((EXPORT_MAX_DATAGRAM - EXPORT_JSON_WRAPPER) / EXPORT_JSON_RECORD_MAX)
+
+#ifdef EXPORT_FORMAT_BINARY
+#define EXPORT_BATCH EXPORT_BINARY_BATCH
+#else
+#define EXPORT_BATCH EXPORT_JSON_BATCH
+#endif
+
+K_MSGQ_DEFINE(export_queue, sizeof(rid_detection_t), EXPORT_QUEUE_DEPTH, 4);
+
+static int export_sock = -1;
+static struct sockaddr_in export_collector;
+static uint8_t export_datagram[EXPORT_MAX_DATAGRAM];
+static uint32_t export_seq;
+static uint32_t export_last_send_ms;
+
+// metrics since the last export_print_stats()
+static uint32_t export_queue_drops;  // records dropped because the queue was full
+static uint32_t export_send_errors;
+static uint32_t export_datagrams;
+static uint32_t export_records;
+static uint32_t export_bytes;
+static uint32_t export_send_us_total;
+static uint32_t export_send_us_max;
+
+
+static int export_init(void) {
+	export_collector.sin_family = AF_INET;
+	export_collector.sin_port = htons(EXPORT_COLLECTOR_PORT);
+	if (zsock_inet_pton(AF_INET, EXPORT_COLLECTOR_ADDR, &export_collector.sin_addr) != 1) {
+		LOG_ERR("Invalid export collector address %s", EXPORT_COLLECTOR_ADDR);
+		return -EINVAL;
+	}
+
+	export_sock = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (export_sock < 0) {
+		LOG_ERR("Export socket failed (%d)", errno);
+		return -errno;
+	}
+	LOG_INF("Exporting detections to %s:%d", EXPORT_COLLECTOR_ADDR, EXPORT_COLLECTOR_PORT);
+	return 0;
+}
+
+
+static void export_detection(const rid_detection_t* det) {
+	/*
+	 Queue a record for export. Called from the scan path, so it never blocks.
+	 */
+	if (k_msgq_put(&export_queue, det, K_NO_WAIT) != 0) {
+		export_queue_drops++;
+	}
+}
+
+
+#ifndef EXPORT_FORMAT_BINARY
+static int export_json_deg(char* buf, size_t size, int32_t deg_e7) {
+	// deg * 10^7 as a decimal string without float formatting (not available with the nano cbprintf)
+	uint32_t abs_deg = deg_e7 < 0 ? -(int64_t) deg_e7 : deg_e7;
+	return snprintk(buf, size, "%s%u.%07u", deg_e7 < 0 ? "-" : "", abs_deg / 10000000, abs_deg % 10000000);
+}
+
+
+static int export_json_record(char* buf, size_t size, const rid_detection_t* det) {
+	/*
+	 Encode one record as an ASTM F3411 Net-RID style flight object. Enumerations are sent as their numeric ASTM
+	 values. Returns the encoded length, or a value >= size if it did not fit.
+	 */
+	char id[2 * sizeof(det->uas_id) + 1];
+	char lat[16];
+	char lng[16];
+	char rx_utc[24] = "null";
+	char data_age[12] = "null";
+	uint32_t abs_vertical_speed = det->vertical_speed_cms < 0 ? -det->vertical_speed_cms : det->vertical_speed_cms;
+	int len = 0;
+	bool printable = true;
+
+	for (int i=0; i<sizeof(det->uas_id) && det->uas_id[i] != 0; i++) {
+		if (det->uas_id[i] < 0x20 || det->uas_id[i] > 0x7E || det->uas_id[i] == '"' || det->uas_id[i] == '\\') {
+			printable = false;
+		}
+	}
+	for (int i=0; i<sizeof(det->uas_id); i++) {
+		if (printable && det->uas_id[i] == 0) {
+			break;
+		}
+		len += snprintk(&id[len], sizeof(id) - len, printable ? "%c" : "%02X", det->uas_id[i]);
+	}
+	id[len] = '\0';
+	export_json_deg(lat, sizeof(lat), det->lat);
+	export_json_deg(lng, sizeof(lng), det->lon);
+	if (det->time_source != RID_TIME_NONE) {
+		// UTC in seconds with ms, without 64-bit formatting (not available with the nano cbprintf)
+		snprintk(rx_utc, sizeof(rx_utc), "%u.%03u", (uint32_t) (det->rx_utc_ms / 1000), (uint32_t) (det->rx_utc_ms % 1000));
+	}
+	if (det->data_age_ms != RID_DATA_AGE_UNKNOWN) {
+		snprintk(data_age, sizeof(data_age), "%d", det->data_age_ms);
+	}
+
+	return snprintk(buf, size,
+			"{\"id\":\"%s\",\"aircraft_type\":%u,\"current_state\":{\"rx_uptime_ms\":%u,\"timestamp\":%u,"
+			"\"operational_status\":%u,\"position\":{\"lat\":%s,\"lng\":%s,\"alt\":%d},\"track\":%u,"
+			"\"speed\":%u.%02u,\"vertical_speed\":%s%u.%02u,\"rssi\":%d,\"flags\":%u,\"loss\":%u,\"rx_interval_ms\":%u,"
+			"\"rx_utc\":%s,\"data_age_ms\":%s}}",
+			id, det->ua_type, det->rx_uptime_ms, det->timestamp, det->op_status, lat, lng,
+			det->geodetic_altitude_m, det->track_direction, det->speed_cms / 100, det->speed_cms % 100,
+			det->vertical_speed_cms < 0 ? "-" : "", abs_vertical_speed / 100, abs_vertical_speed % 100,
+			det->rssi_filtered, det->track_flags, det->loss_percent, det->rx_interval_ms, rx_utc, data_age);
+}
+#endif
+
+
+static void export_send(size_t len, uint32_t records) {
+	uint32_t start = k_cycle_get_32();
+	int ret = zsock_sendto(export_sock, export_datagram, len, 0, (struct sockaddr*) &export_collector,
+			       sizeof(export_collector));
+	uint32_t send_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+	export_seq++;
+	if (ret < 0) {
+		export_send_errors++;
+		return;
+	}
+	export_datagrams++;
+	export_records += records;
+	export_bytes += len;
+	export_send_us_total += send_us;
+	export_send_us_max = MAX(export_send_us_max, send_us);
+}
+
+
+static void export_flush(void) {
+	/*
+	 Drain the queue into as many datagrams as needed.
+	 */
+	rid_detection_t det;
+
+	while (k_msgq_num_used_get(&export_queue) > 0) {
+		uint32_t records = 0;
+#ifdef EXPORT_FORMAT_BINARY
+		rid_batch_header_t* header = (rid_batch_header_t*) export_datagram;
+		size_t len = sizeof(*header);
+
+		while (records < EXPORT_BINARY_BATCH && k_msgq_get(&export_queue, &det, K_NO_WAIT) == 0) {
+			latency_record(&latency_rx_export, (int64_t) (k_uptime_get_32() - det.rx_uptime_ms) * 1000);
+			memcpy(&export_datagram[len], &det, sizeof(det));
+			len += sizeof(det);
+			records++;
+		}
+		header->magic = RID_BATCH_MAGIC;
+		header->version = RID_BATCH_VERSION;
+		header->count = records;
+		header->seq = export_seq;
+		header->tx_uptime_ms = k_uptime_get_32();
+#else
+		char* buf = (char*) export_datagram;
+		size_t len = snprintk(buf, sizeof(export_datagram), "{\"seq\":%u,\"flights\":[", export_seq);
+
+		// leave room for the closing "]}"; a record that does not fit stays queued for the next datagram
+		while (k_msgq_peek(&export_queue, &det) == 0) {
+			int n = export_json_record(&buf[len + (records > 0)], sizeof(export_datagram) - len - 2 - (records > 0), &det);
+			if (n >= sizeof(export_datagram) - len - 2 - (records > 0)) {
+				if (records == 0) {  // can never fit
+					k_msgq_get(&export_queue, &det, K_NO_WAIT);
+					export_queue_drops++;
+				}
+				break;
+			}
+			if (records > 0) {
+				buf[len++] = ',';
+			}
+			len += n;
+			records++;
+			k_msgq_get(&export_queue, &det, K_NO_WAIT);
+			latency_record(&latency_rx_export, (int64_t) (k_uptime_get_32() - det.rx_uptime_ms) * 1000);
+		}
+		len += snprintk(&buf[len], sizeof(export_datagram) - len, "]}");
+		if (records == 0) {
+			continue;
+		}
+#endif
+		export_send(len, records);
+	}
+}
+
+
+static void export_poll(void) {
+	/*
+	 Called from the main loop while no scan is in progress: send a datagram if one is full or the interval is up.
+	 */
+	uint32_t now = k_uptime_get_32();
+
+	if (export_sock < 0) {
+		return;
+	}
+	if (k_msgq_num_used_get(&export_queue) >= EXPORT_BATCH ||
+	    (k_msgq_num_used_get(&export_queue) > 0 && now - export_last_send_ms >= EXPORT_INTERVAL_MS)) {
+		export_flush();
+		export_last_send_ms = now;
+	}
+}
+
+
+static void export_print_stats(void) {
+	/*
+	 Log the export metrics since the last call and start over (main loop stats tick).
+	 */
+	if (export_sock < 0) {
+		return;
+	}
+	LOG_INF("Export: %u datagrams, %u records (%u per datagram), %u bytes, send %u us avg / %u us max, "
+		"%u send errors, %u queue drops",
+		export_datagrams, export_records, export_datagrams ? export_records / export_datagrams : 0, export_bytes,
+		export_datagrams ? export_send_us_total / export_datagrams : 0, export_send_us_max,
+		export_send_errors, export_queue_drops);
+	export_datagrams = 0;
+	export_records = 0;
+	export_bytes = 0;
+	export_send_us_total = 0;
+	export_send_us_max = 0;
+	export_send_errors = 0;
+	export_queue_drops = 0;
+}
+
+#else
+
+static inline int export_init(void) {
+	return 0;
+}
+
+static inline void export_detection(const rid_detection_t* det) {
+	ARG_UNUSED(det);
+}
+
+static inline void export_poll(void) {
+}
+
+static inline void export_print_stats(void) {
+}
+
+#endif
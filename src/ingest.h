@@ -0,0 +1,201 @@
+// Message counter aware ingest of decoded ODID frames.
+//
+// Every ODID frame carries an 8-bit message counter: per message pack (Wi-Fi, Bluetooth 5) or per message type
+// (Bluetooth 4, one message per advertisement). For every transmitter address and counter type the track keeps a
+// 32 counter receive window, which tells repeats of a frame that was already received (the same beacon seen by the next
+// scan) from new frames, counts the frames that never arrived once they leave the window and detects frames that
+// arrive late. The Wi-Fi and Bluetooth transports of a drone have their own addresses and, in most implementations,
+// their own counters, so a frame that already arrived over the other radio is recognized by its messages instead:
+// a short-lived cache of message hashes. The same cache drops the static messages (Basic ID, Self-ID, Operator ID)
+// that Bluetooth 4 transmitters repeat with a new counter every time, so they are reported once per
+// INGEST_CROSS_WINDOW_MS. All checks are constant time.
+
+#define INGEST_WINDOW 32  // counters per receive window (bits of track_t.counter_window)
+#define INGEST_COUNTER_RESYNC_MS 10000  // silence after which the counters start over (wrap / transmitter restart)
+#define INGEST_RECENT_SIZE 512  // message hash cache slots, must be a power of 2
+#define INGEST_CROSS_WINDOW_MS 2000  // how long a received message makes the same message a duplicate, on either radio
+#define INGEST_INTERVAL_ALPHA 0.2f  // EWMA weight of the newest interval between unique frames
+
+enum INGEST_RESULT {
+	INGEST_NEW = 0,
+	INGEST_LATE = 1,  // not received before, but older than the newest counter
+	INGEST_DUPLICATE = 2,  // same counter again on this address, or every message recently received on this radio
+	INGEST_CROSS_DUPLICATE = 3  // every message already received on the other radio
+};
+
+typedef struct {
+	uint32_t hash;  // 0 = empty
+	uint32_t rx_ms;
+	uint8_t source;
+} ingest_recent_t;
+
+static ingest_recent_t ingest_recent[INGEST_RECENT_SIZE];
+
+// cumulative counters (worker thread only)
+static uint32_t ingest_unique;
+static uint32_t ingest_duplicates;
+static uint32_t ingest_cross_duplicates;
+static uint32_t ingest_lost;
+static uint32_t ingest_reordered;
+
+
+static inline uint32_t ingest_msg_hash(const uint8_t* msg) {
+	// FNV-1a over one 25 byte message, never 0
+	uint32_t hash = 2166136261u;
+	for (int i=0; i<ODID_MSG_LEN; i++) {
+		hash = (hash ^ msg[i]) * 16777619u;
+	}
+	return hash | 1;
+}
+
+
+static bool ingest_seen_recently(const uint8_t* msgs, int num_msg, uint8_t source, uint32_t now_ms, bool* other_radio) {
+	/*
+	 Whether every message of the frame was already received within INGEST_CROSS_WINDOW_MS of its first sighting, on
+	 either radio (other_radio: on the other radio for at least one of them). Unseen messages are recorded; seen ones
+	 keep their first sighting, so an unchanged message is still reported once per window.
+	 */
+	bool seen = true;
+
+	*other_radio = false;
+	for (int i=0; i<num_msg; i++) {
+		uint32_t hash = ingest_msg_hash(&msgs[i * ODID_MSG_LEN]);
+		ingest_recent_t* entry = &ingest_recent[hash & (INGEST_RECENT_SIZE - 1)];
+
+		if (entry->hash != hash || now_ms - entry->rx_ms > INGEST_CROSS_WINDOW_MS) {
+			seen = false;
+			entry->hash = hash;
+			entry->source = source;
+			entry->rx_ms = now_ms;
+		} else if (entry->source != source) {
+			*other_radio = true;
+		}
+	}
+	return seen;
+}
+
+
+static void ingest_window_reset(track_t* track, int type, uint8_t counter) {
+	// counters still missing from the old window are lost
+	if (track->counter_valid & (1 << type)) {
+		track->frames_lost += track->counter_span[type] - __builtin_popcount(track->counter_window[type]);
+		ingest_lost += track->counter_span[type] - __builtin_popcount(track->counter_window[type]);
+	}
+	track->counter_valid |= 1 << type;
+	track->counter_last[type] = counter;
+	track->counter_span[type] = 1;
+	track->counter_window[type] = 1;
+}
+
+
+static enum INGEST_RESULT ingest_counter(track_t* track, int type, uint8_t counter, uint32_t now_ms) {
+	/*
+	 Classify a frame by its message counter and advance the receive window of its counter type.
+	 */
+	if (!(track->counter_valid & (1 << type)) || now_ms - track->last_seen_ms > INGEST_COUNTER_RESYNC_MS) {
+		ingest_window_reset(track, type, counter);
+		return INGEST_NEW;
+	}
+
+	uint8_t ahead = counter - track->counter_last[type];  // modulo 256
+	uint32_t window = track->counter_window[type];
+	uint32_t span = track->counter_span[type];
+
+	if (ahead == 0) {
+		return INGEST_DUPLICATE;
+	}
+	if (ahead >= 128) {  // behind the newest counter
+		uint32_t behind = 256 - ahead;
+		if (behind >= span) {  // older than the window: most likely the transmitter restarted
+			ingest_window_reset(track, type, counter);
+			return INGEST_NEW;
+		}
+		if (window & (1u << behind)) {
+			return INGEST_DUPLICATE;
+		}
+		track->counter_window[type] = window | (1u << behind);
+		return INGEST_LATE;
+	}
+
+	// counters shifted out of the window without having been received are lost, as are counters skipped entirely
+	uint32_t lost = 0;
+	if (ahead >= INGEST_WINDOW) {
+		lost = span - __builtin_popcount(window) + (ahead - INGEST_WINDOW);
+		window = 0;
+		span = 0;
+	} else if (span + ahead > INGEST_WINDOW) {
+		uint32_t leaving = span + ahead - INGEST_WINDOW;
+		uint32_t leaving_mask = ((1u << leaving) - 1) << (span - leaving);
+		lost = leaving - __builtin_popcount(window & leaving_mask);
+		span -= leaving;
+	}
+	track->frames_lost += lost;
+	ingest_lost += lost;
+	track->counter_last[type] = counter;
+	track->counter_span[type] = MIN(span + ahead, INGEST_WINDOW);
+	track->counter_window[type] = ahead >= INGEST_WINDOW ? 1 : (window << ahead) | 1;
+	return INGEST_NEW;
+}
+
+
+static enum INGEST_RESULT ingest_frame(track_t* track, uint8_t source, int counter_type, uint8_t counter,
+				       const uint8_t* msgs, int num_msg, uint32_t now_ms) {
+	/*
+	 @brief: decide whether a received ODID frame carries anything new, and update the reception statistics
+
+	 @param[in]  track: track of the transmitter address (before track_update for this frame)
+	 @param[in]  source: RID_SOURCE of the frame
+	 @param[in]  counter_type: ODID message type of a single message, or TRACK_COUNTER_PACK
+	 @param[in]  counter: message counter of the frame
+	 @param[in]  msgs: the 25 byte messages of the frame
+	 @param[in]  num_msg: number of messages
+	 @param[in]  now_ms: local receive time
+	 @return: INGEST_NEW or INGEST_LATE if the frame should be decoded and reported
+	 */
+	track->source = source;
+
+	enum INGEST_RESULT result = ingest_counter(track, counter_type, counter, now_ms);
+	if (result == INGEST_DUPLICATE) {
+		track->frames_duplicate++;
+		ingest_duplicates++;
+		return result;
+	}
+	bool other_radio;
+	if (ingest_seen_recently(msgs, num_msg, source, now_ms, &other_radio)) {
+		// a new counter, but nothing that was not received in the last INGEST_CROSS_WINDOW_MS
+		track->frames_duplicate++;
+		if (other_radio) {
+			ingest_cross_duplicates++;
+			return INGEST_CROSS_DUPLICATE;
+		}
+		ingest_duplicates++;
+		return INGEST_DUPLICATE;
+	}
+
+	track->frames_unique++;
+	ingest_unique++;
+	if (result == INGEST_LATE) {
+		track->frames_reordered++;
+		ingest_reordered++;
+		return result;
+	}
+	if (track->frames_unique > 1) {
+		uint32_t interval = now_ms - track->last_unique_ms;
+		if (track->rx_interval_ms == 0.0f) {
+			track->rx_interval_ms = interval;
+		} else {
+			track->rx_interval_ms += INGEST_INTERVAL_ALPHA * (interval - track->rx_interval_ms);
+		}
+	}
+	track->last_unique_ms = now_ms;
+	return result;
+}
+
+
+static void ingest_print_stats(void) {
+	/*
+	 Log the ingest metrics (main loop stats tick).
+	 */
+	LOG_INF("Ingest: %u unique frames, %u duplicates, %u duplicates from the other radio, %u lost, %u reordered",
+		ingest_unique, ingest_duplicates, ingest_cross_duplicates, ingest_lost, ingest_reordered);
+}
@@ -0,0 +1,105 @@
+// End-to-end latency histograms of the detection pipeline, to check the freshness of what is reported under load.
+//
+//   air    -> rx      data age at reception: reception UTC minus the Location/Vector timestamp (needs timebase.h)
+//   rx     -> decode  queueing and decoding on the receive worker
+//   rx     -> output  until the record was written to RTT / the log
+//   rx     -> export  until the record left in a UDP datagram
+//
+// Every histogram has one bucket per power of two microseconds, so recording is constant time and percentiles are
+// upper bounds within a factor of 2. Each histogram is only written by one thread and the counts are cumulative.
+
+#define LATENCY_BUCKETS 32
+#define LATENCY_SLA_MS 1000  // freshness target, air -> output
+
+typedef struct {
+	uint32_t buckets[LATENCY_BUCKETS];  // bucket b: latencies below 2^b us
+	uint32_t count;
+	uint32_t max_us;
+} latency_hist_t;
+
+static latency_hist_t latency_air_rx;
+static latency_hist_t latency_rx_decode;
+static latency_hist_t latency_rx_output;
+static latency_hist_t latency_rx_export;
+static uint32_t latency_sla_met;  // records with a known data age delivered within LATENCY_SLA_MS of their timestamp
+static uint32_t latency_sla_missed;
+static uint32_t latency_air_rx_negative;  // data ages below 0 (not in latency_air_rx, which has no negative buckets)
+
+
+static void latency_record(latency_hist_t* hist, int64_t us) {
+	uint32_t value = CLAMP(us, 0, UINT32_MAX);
+	int bucket = value == 0 ? 0 : 32 - __builtin_clz(value);
+
+	hist->buckets[MIN(bucket, LATENCY_BUCKETS - 1)]++;
+	hist->count++;
+	hist->max_us = MAX(hist->max_us, value);
+}
+
+
+static uint32_t latency_percentile_ms(const latency_hist_t* hist, uint32_t percent) {
+	/*
+	 Upper bound of the given percentile in ms (0 if nothing was recorded).
+	 */
+	uint32_t target = ((uint64_t) hist->count * percent + 99) / 100;
+	uint32_t seen = 0;
+
+	for (int b=0; b<LATENCY_BUCKETS; b++) {
+		seen += hist->buckets[b];
+		if (seen >= target && seen > 0) {
+			return (uint32_t) MIN((1ull << b), hist->max_us) / 1000;
+		}
+	}
+	return hist->max_us / 1000;
+}
+
+
+static void latency_record_data_age(int32_t data_age_ms) {
+	/*
+	 A known data age (worker thread). Negative ages are expected: the System message time base only bounds the UTC
+	 offset from below, and transmitter clocks may run ahead. They are counted, not clamped into the 0 bucket.
+	 */
+	if (data_age_ms < 0) {
+		latency_air_rx_negative++;
+		return;
+	}
+	latency_record(&latency_air_rx, data_age_ms * 1000ll);
+}
+
+
+static void latency_record_output(int32_t data_age_ms, uint32_t rx_cycles) {
+	/*
+	 A record was output (worker thread): rx -> output, and air -> output against the SLA when the data age is known.
+	 */
+	uint32_t output_us = k_cyc_to_us_floor32(k_cycle_get_32() - rx_cycles);
+
+	latency_record(&latency_rx_output, output_us);
+	if (data_age_ms != RID_DATA_AGE_UNKNOWN) {
+		if ((int64_t) data_age_ms + output_us / 1000 <= LATENCY_SLA_MS) {
+			latency_sla_met++;
+		} else {
+			latency_sla_missed++;
+		}
+	}
+}
+
+
+static void latency_log(const char* name, const latency_hist_t* hist) {
+	LOG_INF("Latency %s: %u samples, p50 %u ms, p95 %u ms, p99 %u ms, max %u ms", name, hist->count,
+		latency_percentile_ms(hist, 50), latency_percentile_ms(hist, 95), latency_percentile_ms(hist, 99),
+		hist->max_us / 1000);
+}
+
+
+static void latency_print_stats(void) {
+	/*
+	 Log the histograms and the time base (main loop stats tick).
+	 */
+	latency_log("air->rx", &latency_air_rx);
+	LOG_INF("Latency air->rx: %u samples with a negative data age", latency_air_rx_negative);
+	latency_log("rx->decode", &latency_rx_decode);
+	latency_log("rx->output", &latency_rx_output);
+	latency_log("rx->export", &latency_rx_export);
+	LOG_INF("Freshness: %u of %u records within %u ms of their timestamp; time source %d (%u System samples, "
+		"%u rejected)", latency_sla_met, latency_sla_met + latency_sla_missed, LATENCY_SLA_MS, timebase_source,
+		timebase_system_samples, timebase_system_rejected);
+}
@@ -12,10 +12,13 @@
 LOG_MODULE_REGISTER(scan, CONFIG_LOG_DEFAULT_LEVEL);
 
 
+#ifdef CONFIG_HAS_NRFX
 #include <nrfx_clock.h>
+#endif
 #include <zephyr/kernel.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <zephyr/shell/shell.h>
 #include <zephyr/sys/printk.h>
 #include <zephyr/init.h>
@@ -38,79 +41,131 @@ LOG_MODULE_REGISTER(scan, CONFIG_LOG_DEFAULT_LEVEL);
 
 #include "net_private.h"
 
-#include "enums.h"
 #include "utils.h"
+#include "timebase.h"
+#include "latency.h"
+#include "report.h"
+#include "export.h"
 #include "wifi_scan.h"
+#include "rx_queue.h"
+#include "ingest.h"
 #include "bluetooth_scan.h"
 
+#define STATS_INTERVAL_MS 10000  // how often the main loop logs the metrics of every module
+
 
 void handle_wifi_raw_scan_result(struct net_mgmt_event_callback *cb) {
 	struct wifi_raw_scan_result *raw =
 		(struct wifi_raw_scan_result *)cb->info;
+
+	rx_submit(raw);  // runs in the net_mgmt thread, so only prefilter and queue here
+}
+
+
+static void process_frame(rx_frame_t* frame) {
 	int channel;
-	int band;
 	int rssi;
-	uint8_t mac_string_buf[sizeof("xx:xx:xx:xx:xx:xx")];
 
-	rssi = raw->rssi;
-	channel = wifi_freq_to_channel(raw->frequency);
-	band = wifi_freq_to_band(raw->frequency);
+	rssi = frame->rssi;
+	channel = frame->source == RID_SOURCE_WIFI ? wifi_freq_to_channel(frame->frequency) : 0;
+
+	track_t* track = track_lookup(frame->mac, frame->rx_ms);
+	enum INGEST_RESULT result = ingest_frame(track, frame->source, frame->counter_type, frame->counter,
+						 &frame->data[ODID_PACK_HDR_LEN], frame->num_msg_in_pack, frame->rx_ms);
+	rx_mark_known(frame->mac);
+	if (result == INGEST_DUPLICATE || result == INGEST_CROSS_DUPLICATE) {
+		// nothing new to decode or report, but still a valid RSSI sample
+		track_update_rssi(track, rssi, frame->rx_ms);
+		track->last_seen_ms = frame->rx_ms;
+		return;
+	}
+
+#if PRINT_INFO
+	uint8_t mac_string_buf[sizeof("xx:xx:xx:xx:xx:xx")];
 
-	int odid_identifier_idx = contains(raw->data, sizeof(raw->data), identifier, sizeof(identifier));
+	if (frame->source == RID_SOURCE_WIFI) {
+		int band = wifi_freq_to_band(frame->frequency);
 
-	// if (rssi >= -14) {
-	if (odid_identifier_idx != -1) {
 		LOG_INF("WIFI SCAN RECEIVED\n");
 		LOG_INF("%-4u (%-6s) | %-4d | %s |      %-4d        ",
 			channel,
 			wifi_band_txt(band),
 			rssi,
-			net_sprint_ll_addr_buf(raw->data + 10, WIFI_MAC_ADDR_LEN, mac_string_buf, sizeof(mac_string_buf)), raw->frame_length);
-		
-		if (PRINT_INFO) {
-			k_sleep(K_SECONDS(0.01));
-			log_hexdump(raw->data, sizeof(raw->data));
-			k_sleep(K_SECONDS(0.01));
-			printf("\n\n\n");
-		}
+			net_sprint_ll_addr_buf(frame->mac, WIFI_MAC_ADDR_LEN, mac_string_buf, sizeof(mac_string_buf)), frame->len);
+	} else {
+		LOG_INF("BLUETOOTH SCAN RECEIVED\n");
+		LOG_INF("%-4d | %s |      %-4d        ",
+			rssi,
+			net_sprint_ll_addr_buf(frame->mac, sizeof(frame->mac), mac_string_buf, sizeof(mac_string_buf)), frame->len);
+	}
+
+	k_sleep(K_SECONDS(0.01));
+	log_hexdump(frame->data, frame->len);
+	k_sleep(K_SECONDS(0.01));
+	printf("\n\n\n");
+#endif
 
-		// flags to hold whether or not a certain message was received
-		msg_flags_t msg_flags;
-		msg_flags.basic_id_flag = 0;
-		msg_flags.location_vector_flag = 0;
-		msg_flags.authentication_flag = 0;
-		msg_flags.self_id_flag = 0;
-		msg_flags.system_flag = 0;
-		msg_flags.operator_id_flag = 0;
+	// flags to hold whether or not a certain message was received
+	msg_flags_t msg_flags;
+	msg_flags.basic_id_flag = 0;
+	msg_flags.location_vector_flag = 0;
+	msg_flags.authentication_flag = 0;
+	msg_flags.self_id_flag = 0;
+	msg_flags.system_flag = 0;
+	msg_flags.operator_id_flag = 0;
+
+	rid_data_t rid = {0};
+
+	parse_hex(frame->data, frame->len, 0, frame->num_msg_in_pack, &msg_flags, &rid);
+	latency_record(&latency_rx_decode, k_cyc_to_us_floor32(k_cycle_get_32() - frame->rx_cycles));
+	if (msg_flags.system_flag) {
+		timebase_system_message(rid.system_timestamp, frame->rx_ms);
+	}
 
-		uint8_t num_msg_in_pack = raw->data[odid_identifier_idx+7];
+	if (frame->source == RID_SOURCE_WIFI) {
+		track->channel = wifi_freq_to_exact_channel(frame->frequency);
+	}
+	track_update(track, rssi, &msg_flags, &rid, frame->rx_ms);
+#if PRINT_INFO
+	printf("FILTERED RSSI: %d.  RSSI TREND (dB/s): %d.  POSITION ERROR (m): %d.  FLAGS: %d.\n",
+	       (int) track->rssi, (int) track->rssi_trend, (int) track->position_error, track->flags);
+	printf("MESSAGE COUNTER: %d.  LOSS (%%): %d.  UNIQUE FRAME INTERVAL (ms): %d.%s\n\n",
+	       frame->counter, track_loss_percent(track), (int) track->rx_interval_ms, result == INGEST_LATE ? "  (LATE)" : "");
+#endif
 
-		parse_hex(raw->data, sizeof(raw->data), odid_identifier_idx, num_msg_in_pack, &msg_flags);
+	rid_detection_t det;
+	build_detection(&det, frame->source, frame->mac, rssi, channel, frame->rx_ms, frame->counter, &msg_flags, &rid,
+			track);
+	if (det.data_age_ms != RID_DATA_AGE_UNKNOWN) {
+		latency_record_data_age(det.data_age_ms);
 	}
+	emit_detection(&det);
+	latency_record_output(det.data_age_ms, frame->rx_cycles);
+	export_detection(&det);
 }
 
 
+static void rx_worker(void) {
+	static rx_frame_t frame;
 
+	while (1) {
+		if (rx_get(&frame) == 0) {
+			process_frame(&frame);
+		}
+	}
+}
 
-static void handle_bluetooth_scan_result(struct bt_scan_device_info *device_info) {
-	int err;
-	char addr[BT_ADDR_LE_STR_LEN];
-	struct bt_conn_le_create_param *conn_params;
+// below the net_mgmt thread, so event delivery always preempts decoding
+K_THREAD_DEFINE(rx_worker_tid, RX_WORKER_STACK_SIZE, rx_worker, NULL, NULL, NULL, RX_WORKER_PRIORITY, 0, 0);
 
-	bt_addr_le_to_str(device_info->recv_info->addr, addr, sizeof(addr));
 
-	uint16_t hex_dump_len = device_info->adv_data->len;
 
-	printk("\nHex Dump Length: %d\n", hex_dump_len);
-	printk("Raw Hex Dump: \n");
-	log_hexdump(device_info->adv_data->data, hex_dump_len);
-	printk("\n");
 
-	err = bt_scan_stop();
-	if (err) {
-		printk("Stop LE scan failed (err %d)\n", err);
-	}
-	bt_scan_finished = 1;  // set global variable to indicate scanning is not longer in progress
+static void handle_bluetooth_scan_result(struct bt_scan_device_info *device_info) {
+	// runs in the Bluetooth receive thread: ODID advertisements take the same path as the Wi-Fi frames (rx_queue.h),
+	// and are printed by the worker
+	rx_submit_bt(device_info->recv_info->addr->a.val, device_info->recv_info->rssi,
+		     device_info->adv_data->data, device_info->adv_data->len);
 }
 
 
@@ -118,6 +173,8 @@ static void handle_bluetooth_scan_result(struct bt_scan_device_info *device_info
 int main(void) {
 	LOG_INF("==================================PROGRAM STARTING==================================");
 
+	report_init();
+	export_init();
 
 	// wifi event callback
 	net_mgmt_init_event_callback(&wifi_shell_mgmt_cb,
@@ -132,14 +189,15 @@ int main(void) {
 	BT_SCAN_CB_INIT(bluetooth_scan_cb, NULL, handle_bluetooth_scan_result, NULL, NULL);  // only pass in callback for when no filters matched (so whenever any BT coded phy is detected)
 	int err = bt_enable(NULL);
 	if (err) {
-		printk("Bluetooth init failed (err %d)\n", err);
-		return 0;
-	}
-	printk("Bluetooth initialized\n");
+		printk("Bluetooth init failed (err %d), scanning Wi-Fi only\n", err);  // e.g. native_sim without a controller
+	} else {
+		printk("Bluetooth initialized\n");
 
-	// bluetooth event callback
-	bluetooth_scan_init();
-	bt_scan_cb_register(&bluetooth_scan_cb);
+		// bluetooth event callback
+		bluetooth_scan_init();
+		bt_scan_cb_register(&bluetooth_scan_cb);
+	}
+	bool bluetooth = err == 0;
 
 
 
@@ -148,30 +206,38 @@ int main(void) {
 	nrfx_clock_divider_set(NRF_CLOCK_DOMAIN_HFCLK,
 			       NRF_CLOCK_HFCLK_DIV_1);
 #endif
+#ifdef CONFIG_HAS_NRFX
 	LOG_INF("Starting %s with CPU frequency: %d MHz", CONFIG_BOARD, SystemCoreClock / MHZ(1));  // should be nrf7002dk_nrf5340_cpuapp with 128 MHz
+#endif
 
 
 
-	// Conduct wifi scan
-	wifi_scan_finished = 1;
-	while(1) {
-		if (wifi_scan_finished == 1) {  // only perform a scan if not another scan is currently in progress
-			wifi_scan();
-		}
-		k_sleep(K_SECONDS(0.01));
-	}
+	// Conduct wifi scans; bluetooth scans run continuously alongside them (the radios are separate)
+	uint32_t last_stats_ms = 0;
 
-	//conduct bluetooth scan
+	wifi_scan_finished = 1;
 	bt_scan_finished = 1;
 	while(1) {
-		if (bt_scan_finished == 1) {  // only perform a scan if not another scan is currently in progress
-			err = bt_scan_start(BT_SCAN_TYPE_SCAN_ACTIVE);
-			bt_scan_finished = 0;  // set global variable to indicate scanning currently in progresss
+		if (bluetooth && bt_scan_finished == 1) {  // not started yet, or starting failed
+			err = bt_scan_start(BT_SCAN_TYPE_SCAN_PASSIVE);
 			if (err) {
 				printk("Scanning failed to start (err %d)\n", err);
-				k_sleep(K_SECONDS(1));  // sleep then try again
+			} else {
+				bt_scan_finished = 0;
 			}
-			// printk("Scanning successfully started\n");
+		}
+		if (wifi_scan_finished == 1) {  // only perform a scan if not another scan is currently in progress
+			export_poll();  // the radio is free between scans, so this is when detections get sent
+			timebase_poll();
+			if (k_uptime_get_32() - last_stats_ms >= STATS_INTERVAL_MS) {
+				last_stats_ms = k_uptime_get_32();
+				wifi_scan_print_stats();
+				rx_print_stats();
+				ingest_print_stats();
+				latency_print_stats();
+				export_print_stats();
+			}
+			wifi_scan();
 		}
 		k_sleep(K_SECONDS(0.01));
 	}
@@ -0,0 +1,113 @@
+#include <string.h>
+
+#include "detection.h"
+#include "track.h"
+
+#ifdef CONFIG_USE_SEGGER_RTT
+#include <SEGGER_RTT.h>
+
+// detection records get their own RTT up-buffer so they never interleave with log text on channel 0
+#define DETECTION_RTT_CHANNEL 1
+#define DETECTION_RTT_BUFFER_SIZE 2048
+
+static uint8_t detection_rtt_buf[DETECTION_RTT_BUFFER_SIZE];
+static uint32_t detections_dropped;  // records that did not fit into the RTT buffer (host not reading fast enough)
+#endif
+
+static uint32_t detections_emitted;
+
+
+static void report_init(void) {
+#ifdef CONFIG_USE_SEGGER_RTT
+	// never block the scan path on a slow host; drop the whole record instead
+	SEGGER_RTT_ConfigUpBuffer(DETECTION_RTT_CHANNEL, "rid", detection_rtt_buf, sizeof(detection_rtt_buf),
+				  SEGGER_RTT_MODE_NO_BLOCK_SKIP);
+#endif
+}
+
+
+static void build_detection(rid_detection_t* det, enum RID_SOURCE source, const uint8_t* mac, int rssi, int channel,
+			    uint32_t rx_ms, uint8_t msg_counter, const msg_flags_t* msg_flags, const rid_data_t* rid,
+			    const track_t* track) {
+	/*
+	 Pack the decoded RID fields of one received frame into a detection record.
+	 */
+	memset(det, 0, sizeof(*det));
+	det->magic = RID_DETECTION_MAGIC;
+	det->version = RID_DETECTION_VERSION;
+	det->len = sizeof(*det);
+	det->source = source;
+
+	det->rx_uptime_ms = rx_ms;
+	memcpy(det->mac, mac, sizeof(det->mac));
+	det->rssi = rssi;
+	det->channel = channel;
+	det->msg_flags = (msg_flags->basic_id_flag ? RID_MSG_BASIC_ID : 0) |
+			 (msg_flags->location_vector_flag ? RID_MSG_LOCATION_VECTOR : 0) |
+			 (msg_flags->authentication_flag ? RID_MSG_AUTHENTICATION : 0) |
+			 (msg_flags->self_id_flag ? RID_MSG_SELF_ID : 0) |
+			 (msg_flags->system_flag ? RID_MSG_SYSTEM : 0) |
+			 (msg_flags->operator_id_flag ? RID_MSG_OPERATOR_ID : 0);
+
+	det->id_type = rid->id_type;
+	det->ua_type = rid->ua_type;
+	memcpy(det->uas_id, rid->uas_id, sizeof(det->uas_id));
+
+	det->op_status = rid->op_status;
+	det->track_direction = rid->track_direction;
+	det->speed_cms = rid->speed * 100;
+	det->vertical_speed_cms = rid->vertical_speed * 100;
+	det->lat = rid->lat;
+	det->lon = rid->lon;
+	det->geodetic_altitude_m = rid->geodetic_altitude;
+	det->height_m = rid->height;
+	det->timestamp = rid->timestamp;
+
+	det->operator_lat = rid->operator_lat;
+	det->operator_lon = rid->operator_lon;
+	det->system_timestamp = rid->system_timestamp;
+
+	det->rssi_filtered = track->rssi;
+	det->rssi_trend = CLAMP(track->rssi_trend * 10, -INT16_MAX, INT16_MAX);  // +-3276.7 dB/s
+	det->track_flags = track->flags;
+	det->position_error_m = MIN(track->position_error, UINT16_MAX);
+
+	int32_t lat;
+	int32_t lon;
+	float alt;
+	if (!msg_flags->location_vector_flag && track_predicted_position(track, rx_ms, &lat, &lon, &alt)) {
+		// between Location/Vector messages, report where the motion model puts the transmitter
+		det->lat = lat;
+		det->lon = lon;
+		det->geodetic_altitude_m = alt;
+		det->track_flags |= TRACK_FLAG_PREDICTED;
+		det->position_error_m = 0;  // only measured on position reports
+	}
+
+	det->msg_counter = msg_counter;
+	det->loss_percent = track_loss_percent(track);
+	det->rx_interval_ms = MIN(track->rx_interval_ms, UINT16_MAX);
+
+	int64_t rx_utc_ms = 0;  // not written in place, the record is packed
+	det->time_source = timebase_utc(rx_ms, &rx_utc_ms);
+	det->rx_utc_ms = rx_utc_ms;
+	det->data_age_ms = RID_DATA_AGE_UNKNOWN;
+	if (det->time_source != RID_TIME_NONE && msg_flags->location_vector_flag) {
+		det->data_age_ms = timebase_data_age(rx_utc_ms, rid->timestamp);
+	}
+}
+
+
+static void emit_detection(const rid_detection_t* det) {
+#ifdef CONFIG_USE_SEGGER_RTT
+	if (SEGGER_RTT_Write(DETECTION_RTT_CHANNEL, det, sizeof(*det)) == sizeof(*det)) {
+		detections_emitted++;
+	} else {
+		detections_dropped++;
+	}
+#else
+	// no RTT (e.g. native_sim): hand the raw bytes to the deferred logger, which formats them off the scan path
+	LOG_HEXDUMP_INF(det, sizeof(*det), "det");
+	detections_emitted++;
+#endif
+}
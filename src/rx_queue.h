@@ -0,0 +1,267 @@
+#include <zephyr/sys/atomic.h>
+
+
+// Decoupling of the scan result callbacks from the RID decoding.
+//
+// The net_mgmt callback runs in the thread that delivers the driver's events, so it only does a cheap check of whether
+// a frame can carry Remote ID at all (frame subtype, length and a walk of the tagged elements for the ODID vendor IE)
+// and copies the frames that can into a queue. Bluetooth advertisements with ODID service data go into the same queue,
+// so a single worker thread decodes (and owns the tracks of) both radios. When the worker falls behind, frames are
+// shed in priority order: frames from unknown transmitters once the queue passes RX_SHED_UNKNOWN_LEVEL, frames from
+// known tracks only when it is completely full. Nothing on the callback side ever blocks. Only the message pack and the
+// reception metadata are queued, not the whole frame.
+
+#define RX_QUEUE_DEPTH 16
+#define RX_SHED_UNKNOWN_LEVEL 12  // queued frames above which new transmitters are shed
+#define RX_WORKER_STACK_SIZE 4096
+#define RX_WORKER_PRIORITY K_PRIO_PREEMPT(10)
+#define RX_KNOWN_BITS (4 * MAX_TRACKS)  // must be a power of 2
+
+// 802.11 management frame layout
+#define WIFI_FC_TYPE_MASK 0x0C
+#define WIFI_FC_SUBTYPE_MASK 0xF0
+#define WIFI_FC_SUBTYPE_PROBE_RESP 0x50
+#define WIFI_FC_SUBTYPE_BEACON 0x80
+#define WIFI_FC_SUBTYPE_ACTION 0xD0  // Wi-Fi NAN service discovery frames
+#define WIFI_MGMT_HDR_LEN 24
+#define WIFI_BEACON_IES_OFFSET (WIFI_MGMT_HDR_LEN + 12)  // after timestamp, beacon interval and capabilities
+#define WIFI_EID_VENDOR_SPECIFIC 0xDD
+
+// ODID vendor IE: OUI and type (identifier), message counter, pack header (type/version, message size, count)
+#define ODID_PACK_HDR_LEN 8
+#define ODID_MSG_LEN 25
+#define ODID_MAX_MSGS_IN_PACK 9
+#define ODID_MSG_TYPE_PACK 0xF
+
+// ODID Bluetooth advertisement: service data AD structure with the ASTM UUID and application code, then the counter
+#define BT_DATA_SVC_DATA16 0x16
+#define ODID_BT_UUID 0xFFFA
+#define ODID_BT_APP_CODE 0x0D
+#define ODID_BT_HDR_LEN 5  // AD type, UUID, application code, message counter
+
+// decimal of FA 0B BC 0D
+static const uint8_t identifier[] = {250, 11, 188, 13};
+
+typedef struct {
+	uint32_t rx_ms;  // uptime when the event was delivered
+	uint32_t rx_cycles;  // cycle counter at the same time, for the latency histograms
+	uint8_t source;  // enum RID_SOURCE
+	uint8_t mac[6];
+	int8_t rssi;
+	uint16_t frequency;  // MHz, 0 for Bluetooth
+	uint8_t counter;  // ODID message counter
+	uint8_t counter_type;  // message type of a single message, or TRACK_COUNTER_PACK
+	uint8_t num_msg_in_pack;
+	uint16_t len;  // bytes of data, up to the end of the last message
+	// the message pack from the ODID identifier (Wi-Fi) or the AD type (Bluetooth 5) on, so the messages always start
+	// at data[ODID_PACK_HDR_LEN] (parse_hex() with odid_identifier_idx 0). A Bluetooth 4 message is preceded by its
+	// advertisement header, right-aligned in the first ODID_PACK_HDR_LEN bytes.
+	uint8_t data[ODID_PACK_HDR_LEN + ODID_MAX_MSGS_IN_PACK * ODID_MSG_LEN];
+} rx_frame_t;
+
+K_MSGQ_DEFINE(rx_queue, sizeof(rx_frame_t), RX_QUEUE_DEPTH, 4);
+
+// transmitters that sent a decodable RID frame before (hash bitmap, so a collision only raises a frame's priority)
+static ATOMIC_DEFINE(rx_known_transmitters, RX_KNOWN_BITS);
+
+// cumulative counters, written from both scan callbacks
+static atomic_t rx_events;  // raw scan results delivered by net_mgmt
+static atomic_t rx_not_rid;  // dropped by the prefilter
+static atomic_t rx_bt_events;  // ODID advertisements
+static atomic_t rx_queued;
+static atomic_t rx_shed_unknown;
+static atomic_t rx_shed_known;
+static uint32_t rx_queue_high_water;
+static uint32_t rx_handler_us_max;  // longest time the net_mgmt callback took
+
+
+static int odid_pack_len(const uint8_t* data, int idx, int end) {
+	/*
+	 Bytes from the ODID identifier at idx to the end of its message pack, or -1 if the pack does not fit before end.
+	 */
+	if (idx + ODID_PACK_HDR_LEN > end) {
+		return -1;
+	}
+	int num_msg_in_pack = data[idx + 7];
+	int len = ODID_PACK_HDR_LEN + num_msg_in_pack * ODID_MSG_LEN;
+	if (num_msg_in_pack == 0 || num_msg_in_pack > ODID_MAX_MSGS_IN_PACK || idx + len > end) {
+		return -1;
+	}
+	return len;
+}
+
+
+static int rid_frame_prefilter(const uint8_t* data, int frame_length, int size) {
+	/*
+	 @brief: cheap check whether a raw scan result can carry a Remote ID message pack
+
+	 @param[in]  data: frame, starting with the 802.11 frame control field
+	 @param[in]  frame_length: length of the frame on air
+	 @param[in]  size: bytes of the frame available in data
+	 @return: index of the ODID identifier (FA 0B BC 0D) in data, or -1
+	 */
+	int end = MIN(frame_length, size);
+
+	if (end < WIFI_MGMT_HDR_LEN + ODID_PACK_HDR_LEN + ODID_MSG_LEN || (data[0] & WIFI_FC_TYPE_MASK) != 0) {
+		return -1;  // too short for a single message, or not a management frame
+	}
+
+	switch (data[0] & WIFI_FC_SUBTYPE_MASK) {
+	case WIFI_FC_SUBTYPE_BEACON:
+	case WIFI_FC_SUBTYPE_PROBE_RESP:
+		// walk the tagged elements; a truncated element ends the walk
+		for (int i=WIFI_BEACON_IES_OFFSET; i + 2 <= end && i + 2 + data[i+1] <= end; i += 2 + data[i+1]) {
+			if (data[i] == WIFI_EID_VENDOR_SPECIFIC && data[i+1] >= ODID_PACK_HDR_LEN + ODID_MSG_LEN &&
+			    memcmp(&data[i+2], identifier, sizeof(identifier)) == 0) {
+				return odid_pack_len(data, i + 2, i + 2 + data[i+1]) < 0 ? -1 : i + 2;
+			}
+		}
+		return -1;
+	case WIFI_FC_SUBTYPE_ACTION: {
+		// NAN attributes are nested inside the action frame body, so fall back to a search
+		int idx = contains(&data[WIFI_MGMT_HDR_LEN], end - WIFI_MGMT_HDR_LEN, identifier, sizeof(identifier));
+		if (idx < 0 || odid_pack_len(data, WIFI_MGMT_HDR_LEN + idx, end) < 0) {
+			return -1;
+		}
+		return WIFI_MGMT_HDR_LEN + idx;
+	}
+	default:
+		return -1;
+	}
+}
+
+
+static inline uint32_t rx_known_bit(const uint8_t* mac) {
+	return track_hash(mac) & (RX_KNOWN_BITS - 1);
+}
+
+
+static void rx_enqueue(const rx_frame_t* frame) {
+	/*
+	 Queue a frame for the worker, or shed it: frames from unknown transmitters above RX_SHED_UNKNOWN_LEVEL, any frame
+	 when the queue is full.
+	 */
+	uint32_t used = k_msgq_num_used_get(&rx_queue);
+	bool known = atomic_test_bit(rx_known_transmitters, rx_known_bit(frame->mac));
+
+	if (!known && used >= RX_SHED_UNKNOWN_LEVEL) {
+		atomic_inc(&rx_shed_unknown);
+	} else if (k_msgq_put(&rx_queue, frame, K_NO_WAIT) == 0) {
+		atomic_inc(&rx_queued);
+		rx_queue_high_water = MAX(rx_queue_high_water, used + 1);
+	} else {
+		atomic_inc(known ? &rx_shed_known : &rx_shed_unknown);
+	}
+}
+
+
+static void rx_submit(const struct wifi_raw_scan_result* raw) {
+	/*
+	 Called from the net_mgmt callback for every raw scan result: prefilter, then queue or shed. Never blocks.
+	 */
+	uint32_t start = k_cycle_get_32();
+	atomic_inc(&rx_events);
+
+	int odid_identifier_idx = rid_frame_prefilter(raw->data, raw->frame_length, sizeof(raw->data));
+	if (odid_identifier_idx < 0) {
+		atomic_inc(&rx_not_rid);
+	} else {
+		// only the message pack is needed, which keeps the copy (and the queue) short
+		static rx_frame_t frame;  // only ever used from the net_mgmt thread
+		frame.rx_ms = k_uptime_get_32();
+		frame.rx_cycles = start;
+		frame.source = RID_SOURCE_WIFI;
+		memcpy(frame.mac, raw->data + 10, sizeof(frame.mac));
+		frame.rssi = raw->rssi;
+		frame.frequency = raw->frequency;
+		frame.counter = raw->data[odid_identifier_idx + 4];
+		frame.counter_type = TRACK_COUNTER_PACK;
+		frame.num_msg_in_pack = raw->data[odid_identifier_idx + 7];
+		frame.len = odid_pack_len(raw->data, odid_identifier_idx, sizeof(raw->data));
+		memcpy(frame.data, &raw->data[odid_identifier_idx], frame.len);
+		rx_enqueue(&frame);
+	}
+
+	rx_handler_us_max = MAX(rx_handler_us_max, k_cyc_to_us_ceil32(k_cycle_get_32() - start));
+}
+
+
+static void rx_submit_bt(const uint8_t* addr, int rssi, const uint8_t* data, int len) {
+	/*
+	 @brief: called from the Bluetooth scan callback: queue an advertisement if it carries ODID service data
+
+	 @param[in]  addr: advertiser address (6 bytes)
+	 @param[in]  rssi: RSSI of the advertisement in dBm
+	 @param[in]  data: advertising data (AD structures)
+	 @param[in]  len: length of data
+	 */
+	static rx_frame_t frame;  // only ever used from the Bluetooth receive thread
+
+	for (int i=0; i + 1 < len && data[i] > 0 && i + 1 + data[i] <= len; i += 1 + data[i]) {
+		const uint8_t* ad = &data[i + 1];  // AD type, then the AD data
+		int ad_len = data[i];
+
+		if (ad_len < ODID_BT_HDR_LEN + ODID_MSG_LEN || ad[0] != BT_DATA_SVC_DATA16 ||
+		    sys_get_le16(&ad[1]) != ODID_BT_UUID || ad[3] != ODID_BT_APP_CODE) {
+			continue;
+		}
+		atomic_inc(&rx_bt_events);
+
+		int msg_type = ad[5] >> 4;
+		if (msg_type == ODID_MSG_TYPE_PACK) {
+			// Bluetooth 5: counter and pack header line up with the Wi-Fi vendor IE when starting at the AD type
+			int pack_len = odid_pack_len(ad, 0, ad_len);
+			if (pack_len < 0) {
+				return;
+			}
+			frame.counter_type = TRACK_COUNTER_PACK;
+			frame.num_msg_in_pack = ad[7];
+			frame.len = pack_len;
+			memcpy(frame.data, ad, pack_len);
+		} else if (msg_type < TRACK_COUNTER_PACK) {
+			// Bluetooth 4: a single message right after the counter
+			frame.counter_type = msg_type;
+			frame.num_msg_in_pack = 1;
+			frame.len = ODID_PACK_HDR_LEN + ODID_MSG_LEN;
+			memset(frame.data, 0, ODID_PACK_HDR_LEN - ODID_BT_HDR_LEN);
+			memcpy(&frame.data[ODID_PACK_HDR_LEN - ODID_BT_HDR_LEN], ad, ODID_BT_HDR_LEN + ODID_MSG_LEN);
+		} else {
+			return;
+		}
+		frame.rx_ms = k_uptime_get_32();
+		frame.rx_cycles = k_cycle_get_32();
+		frame.source = RID_SOURCE_BT;
+		memcpy(frame.mac, addr, sizeof(frame.mac));
+		frame.rssi = rssi;
+		frame.frequency = 0;
+		frame.counter = ad[4];
+		rx_enqueue(&frame);
+		return;
+	}
+}
+
+
+static int rx_get(rx_frame_t* frame) {
+	/*
+	 Wait for the next queued frame (worker thread).
+	 */
+	return k_msgq_get(&rx_queue, frame, K_FOREVER);
+}
+
+
+static void rx_mark_known(const uint8_t* mac) {
+	atomic_set_bit(rx_known_transmitters, rx_known_bit(mac));
+}
+
+
+static void rx_print_stats(void) {
+	/*
+	 Log the scan result pipeline metrics (main loop stats tick).
+	 */
+	LOG_INF("Scan results: %u events, %u not RID, %u Bluetooth, %u queued, %u shed (unknown), %u shed (known), "
+		"queue %u/%u (high water %u), callback %u us max (net_mgmt queue %d, timeout %d ms)",
+		(uint32_t) atomic_get(&rx_events), (uint32_t) atomic_get(&rx_not_rid), (uint32_t) atomic_get(&rx_bt_events),
+		(uint32_t) atomic_get(&rx_queued), (uint32_t) atomic_get(&rx_shed_unknown), (uint32_t) atomic_get(&rx_shed_known),
+		k_msgq_num_used_get(&rx_queue), RX_QUEUE_DEPTH, rx_queue_high_water, rx_handler_us_max,
+		CONFIG_NET_MGMT_EVENT_QUEUE_SIZE, CONFIG_NET_MGMT_EVENT_QUEUE_TIMEOUT);
+}
@@ -0,0 +1,163 @@
+#include <zephyr/spinlock.h>
+
+#include "detection.h"
+
+#if defined(EXPORT) && defined(CONFIG_SNTP)
+#include <zephyr/net/socket.h>
+#include <zephyr/net/sntp.h>
+#endif
+
+
+// Mapping of local uptime to UTC.
+//
+// UTC = uptime + offset, with the offset from the best reference seen so far. With network export and CONFIG_SNTP
+// that is the collector's NTP server. Otherwise the ODID System message timestamps are used: whole seconds of the
+// transmitter's clock when the message was built, so every received System message bounds the offset from below, and
+// the largest bound (aged by the worst case drift of the local crystal) converges on the offset as the sub-second
+// phases of many messages are seen. A transmitter whose clock is far ahead of the others is rejected as an outlier
+// until TIMEBASE_OUTLIER_RESYNC consecutive messages disagree with the current estimate.
+
+#define ODID_EPOCH_UNIX_S 1546300800ll  // 2019-01-01T00:00:00Z, epoch of the System message timestamp
+#define TIMEBASE_DRIFT_PPM 50  // worst case local clock drift the System message bound is aged by
+#define TIMEBASE_OUTLIER_MS 2000  // System message bounds further ahead than this are suspicious
+#define TIMEBASE_OUTLIER_RESYNC 5
+#define TIMEBASE_SNTP_PORT 123
+#define TIMEBASE_SNTP_TIMEOUT_MS 200
+#define TIMEBASE_SNTP_INTERVAL_MS 600000
+#define TIMEBASE_SNTP_RETRY_MS 30000
+#define ODID_TIMESTAMP_UNKNOWN 0xFFFF
+#define ODID_TIMESTAMPS_PER_HOUR 36000  // Location/Vector timestamps are 1/10 s since the hour
+
+static struct k_spinlock timebase_lock;
+static enum RID_TIME_SOURCE timebase_source;
+static int64_t timebase_offset_ms;  // UTC ms since the Unix epoch minus uptime ms
+static int64_t timebase_reference_uptime_ms;  // when the offset was last set
+static uint32_t timebase_outliers;  // consecutive rejected System message bounds
+static uint32_t timebase_system_samples;
+static uint32_t timebase_system_rejected;
+
+
+static int64_t timebase_uptime64(uint32_t uptime_ms) {
+	// extend a 32-bit uptime stamp (from the past 49 days) to 64 bits
+	int64_t now = k_uptime_get();
+	return now - (uint32_t) ((uint32_t) now - uptime_ms);
+}
+
+
+static void timebase_set(enum RID_TIME_SOURCE source, int64_t offset_ms, int64_t uptime_ms) {
+	k_spinlock_key_t key = k_spin_lock(&timebase_lock);
+	timebase_source = source;
+	timebase_offset_ms = offset_ms;
+	timebase_reference_uptime_ms = uptime_ms;
+	k_spin_unlock(&timebase_lock, key);
+}
+
+
+static void timebase_system_message(uint32_t system_timestamp, uint32_t rx_ms) {
+	/*
+	 Use the System message timestamp of a frame received at uptime rx_ms as a reference, if nothing better is set.
+	 */
+	int64_t rx = timebase_uptime64(rx_ms);
+	int64_t bound = (ODID_EPOCH_UNIX_S + system_timestamp) * 1000 - rx;  // UTC at reception is at least the timestamp
+
+	k_spinlock_key_t key = k_spin_lock(&timebase_lock);
+	enum RID_TIME_SOURCE source = timebase_source;
+	int64_t offset = timebase_offset_ms;
+	int64_t reference = timebase_reference_uptime_ms;
+	k_spin_unlock(&timebase_lock, key);
+
+	if (system_timestamp == 0 || source > RID_TIME_SYSTEM_MSG) {
+		return;
+	}
+	timebase_system_samples++;
+	if (source == RID_TIME_NONE) {
+		timebase_set(RID_TIME_SYSTEM_MSG, bound, rx);
+		return;
+	}
+
+	int64_t aged = offset - (rx - reference) * TIMEBASE_DRIFT_PPM / 1000000;
+	if (bound > aged + TIMEBASE_OUTLIER_MS && ++timebase_outliers < TIMEBASE_OUTLIER_RESYNC) {
+		timebase_system_rejected++;
+		return;
+	}
+	timebase_outliers = 0;
+	timebase_set(RID_TIME_SYSTEM_MSG, bound > aged + TIMEBASE_OUTLIER_MS ? bound : MAX(aged, bound), rx);
+}
+
+
+static enum RID_TIME_SOURCE timebase_utc(uint32_t uptime_ms, int64_t* utc_ms) {
+	/*
+	 UTC in ms since the Unix epoch at a local uptime. Returns RID_TIME_NONE (and leaves utc_ms) without a reference.
+	 */
+	k_spinlock_key_t key = k_spin_lock(&timebase_lock);
+	enum RID_TIME_SOURCE source = timebase_source;
+	int64_t offset = timebase_offset_ms;
+	k_spin_unlock(&timebase_lock, key);
+
+	if (source != RID_TIME_NONE) {
+		*utc_ms = timebase_uptime64(uptime_ms) + offset;
+	}
+	return source;
+}
+
+
+static int32_t timebase_data_age(int64_t rx_utc_ms, uint16_t timestamp) {
+	/*
+	 Age at reception of Location/Vector data with the given timestamp (1/10 s since the hour), taking the hour
+	 closest to the reception time.
+	 */
+	if (timestamp >= ODID_TIMESTAMPS_PER_HOUR) {  // includes ODID_TIMESTAMP_UNKNOWN
+		return RID_DATA_AGE_UNKNOWN;
+	}
+	int64_t air_ms = rx_utc_ms - rx_utc_ms % 3600000 + timestamp * 100;
+	if (air_ms - rx_utc_ms > 1800000) {
+		air_ms -= 3600000;
+	} else if (rx_utc_ms - air_ms > 1800000) {
+		air_ms += 3600000;
+	}
+	return rx_utc_ms - air_ms;
+}
+
+
+#if defined(EXPORT) && defined(CONFIG_SNTP)
+static uint32_t timebase_last_sntp_ms;
+static bool timebase_sntp_attempted;
+
+static void timebase_poll(void) {
+	/*
+	 Query the collector's NTP server now and then (main loop, between scans since the query blocks briefly).
+	 */
+	uint32_t now = k_uptime_get_32();
+	uint32_t interval = timebase_source == RID_TIME_SNTP ? TIMEBASE_SNTP_INTERVAL_MS : TIMEBASE_SNTP_RETRY_MS;
+
+	if (timebase_sntp_attempted && now - timebase_last_sntp_ms < interval) {
+		return;
+	}
+	timebase_sntp_attempted = true;
+	timebase_last_sntp_ms = now;
+
+	struct sockaddr_in server = { .sin_family = AF_INET, .sin_port = htons(TIMEBASE_SNTP_PORT) };
+	struct sntp_ctx ctx;
+	struct sntp_time time;
+	if (zsock_inet_pton(AF_INET, EXPORT_COLLECTOR_ADDR, &server.sin_addr) != 1 ||
+	    sntp_init(&ctx, (struct sockaddr*) &server, sizeof(server)) < 0) {
+		return;
+	}
+	int64_t sent = k_uptime_get();
+	int ret = sntp_query(&ctx, TIMEBASE_SNTP_TIMEOUT_MS, &time);
+	int64_t received = k_uptime_get();
+	sntp_close(&ctx);
+	if (ret < 0) {
+		LOG_WRN("SNTP query failed (%d)", ret);
+		return;
+	}
+
+	// the server's time applies halfway through the round trip
+	int64_t utc_ms = time.seconds * 1000 + (((uint64_t) time.fraction * 1000) >> 32);
+	timebase_set(RID_TIME_SNTP, utc_ms - (sent + received) / 2, (sent + received) / 2);
+	LOG_INF("SNTP time set, round trip %d ms", (int) (received - sent));
+}
+#else
+static inline void timebase_poll(void) {
+}
+#endif
@@ -0,0 +1,316 @@
+#include <stdbool.h>
+#include <string.h>
+
+#include "detection.h"
+
+
+// Per-transmitter tracks with incremental RSSI and motion filters.
+// Every update is constant time and allocation free: the track table is a fixed-size open addressing hash
+// table keyed by transmitter MAC, and a lookup never probes more than TRACK_MAX_PROBE slots.
+
+#define MAX_TRACKS 256  // must be a power of 2
+#define TRACK_MAX_PROBE 8  // slots checked per lookup; when all are taken the least recently seen one is replaced
+
+// RSSI scalar Kalman filter (random walk model)
+#define TRACK_RSSI_PROCESS_NOISE 0.5f  // dB^2 per second, how fast the true RSSI is allowed to drift
+#define TRACK_RSSI_MEASUREMENT_NOISE 16.0f  // dB^2, per-packet fading/noise
+#define TRACK_RSSI_TREND_ALPHA 0.2f  // EWMA weight of the newest RSSI slope sample (dB/s)
+#define TRACK_RSSI_TREND_MIN_DT_MS 100  // a slope sample spans at least this, so back-to-back frames are accumulated
+
+// position consistency gate: a report is inconsistent if it is further than
+// TRACK_GATE_M + TRACK_GATE_M_PER_S * dt from the position predicted by the previous report's velocity
+#define TRACK_GATE_M 30.0f
+#define TRACK_GATE_M_PER_S 15.0f
+#define TRACK_ALT_GATE_M 30.0f
+#define TRACK_SUSPECT_THRESHOLD 3  // inconsistent reports (decayed by consistent ones) before a track is flagged
+#define TRACK_PREDICT_MAX_MS 10000  // positions are not extrapolated further than this from the last report
+#define ODID_VERTICAL_SPEED_UNKNOWN 63.0f  // m/s, the "unknown" encoding (raw 126)
+
+#define METERS_PER_E7_DEG 0.0111320f  // meters per 10^-7 deg of latitude (and of longitude at the equator)
+
+// ODID message counters: one per message type (Bluetooth 4 sends every message on its own) plus one for message packs
+#define TRACK_COUNTER_PACK 6
+#define TRACK_COUNTER_TYPES 7
+
+typedef struct {
+	bool in_use;
+	uint8_t mac[6];
+	uint32_t first_seen_ms;
+	uint32_t last_seen_ms;
+
+	// RSSI filter
+	float rssi;  // filtered RSSI, dBm
+	float rssi_var;  // filter variance, dB^2
+	float rssi_trend;  // smoothed RSSI slope, dB/s (positive = getting closer)
+	float rssi_trend_start;  // filtered RSSI at the start of the current slope sample, dBm
+	uint32_t rssi_trend_start_ms;
+
+	// constant-velocity motion model, anchored at the last position report
+	bool has_position;
+	bool has_velocity;
+	uint32_t position_ms;  // local receive time of the last position report
+	int32_t lat;  // deg * 10^7
+	int32_t lon;  // deg * 10^7
+	float alt;  // geodetic altitude, m
+	float cos_lat;  // scales longitude to meters at this latitude
+	float v_north;  // m/s
+	float v_east;  // m/s
+	float v_up;  // m/s
+	bool has_v_up;  // false if the vertical speed was reported as unknown
+	float position_error;  // distance between the latest report and its prediction, m
+
+	uint8_t inconsistent_count;
+	uint8_t flags;  // TRACK_FLAG_* bits (detection.h)
+
+	// reception statistics from the ODID message counters (ingest.h), one receive window per counter type
+	uint8_t source;  // RID_SOURCE the address was received on
+	uint8_t channel;  // Wi-Fi channel of the latest frame
+	uint8_t counter_valid;  // bit per counter type
+	uint8_t counter_last[TRACK_COUNTER_TYPES];
+	uint8_t counter_span[TRACK_COUNTER_TYPES];  // counters covered by the window, at most 32
+	uint32_t counter_window[TRACK_COUNTER_TYPES];  // bit i: counter_last - i was received
+	uint32_t frames_unique;
+	uint32_t frames_duplicate;  // same counter again (repeated beacon / scan) or already received on the other radio
+	uint32_t frames_lost;  // counters that left the receive window without being received
+	uint32_t frames_reordered;  // received after a newer counter
+	uint32_t last_unique_ms;
+	float rx_interval_ms;  // smoothed time between unique frames
+} track_t;
+
+static track_t tracks[MAX_TRACKS];
+
+
+static inline float sin_deg(float deg) {
+	/*
+	 Bhaskara I sine approximation (max error ~0.0016). Avoids pulling libm into the minimal libc build.
+	 */
+	float sign = 1.0f;
+	while (deg < 0.0f) {
+		deg += 360.0f;
+	}
+	while (deg >= 360.0f) {
+		deg -= 360.0f;
+	}
+	if (deg > 180.0f) {
+		deg -= 180.0f;
+		sign = -1.0f;
+	}
+	return sign * 4.0f * deg * (180.0f - deg) / (40500.0f - deg * (180.0f - deg));
+}
+
+
+static inline float cos_deg(float deg) {
+	return sin_deg(deg + 90.0f);
+}
+
+
+static inline float sqrt_approx(float x) {
+	/*
+	 Square root by a bit-level initial guess and two Newton steps, good to ~0.01% for distances in meters.
+	 */
+	union { float f; uint32_t i; } u = { .f = x };
+	if (x <= 0.0f) {
+		return 0.0f;
+	}
+	u.i = (u.i >> 1) + 0x1FBD1DF5;
+	u.f = 0.5f * (u.f + x / u.f);
+	u.f = 0.5f * (u.f + x / u.f);
+	return u.f;
+}
+
+
+static inline uint32_t track_hash(const uint8_t* mac) {
+	// FNV-1a over the MAC address
+	uint32_t hash = 2166136261u;
+	for (int i=0; i<6; i++) {
+		hash = (hash ^ mac[i]) * 16777619u;
+	}
+	return hash;
+}
+
+
+static track_t* track_lookup(const uint8_t* mac, uint32_t now_ms) {
+	/*
+	 Find the track of a transmitter, or claim a slot for it. Never fails: when all probed slots are in use
+	 by other transmitters the least recently seen one is recycled.
+	 */
+	uint32_t slot = track_hash(mac) & (MAX_TRACKS - 1);
+	track_t* victim = NULL;
+
+	for (int probe=0; probe<TRACK_MAX_PROBE; probe++) {
+		track_t* track = &tracks[(slot + probe) & (MAX_TRACKS - 1)];
+		if (!track->in_use) {
+			if (victim == NULL || victim->in_use) {
+				victim = track;
+			}
+			continue;
+		}
+		if (memcmp(track->mac, mac, sizeof(track->mac)) == 0) {
+			return track;
+		}
+		if (victim == NULL || (victim->in_use && (int32_t) (track->last_seen_ms - victim->last_seen_ms) < 0)) {
+			victim = track;  // seen less recently than the current candidate (wraparound safe)
+		}
+	}
+
+	memset(victim, 0, sizeof(*victim));
+	victim->in_use = true;
+	memcpy(victim->mac, mac, sizeof(victim->mac));
+	victim->first_seen_ms = now_ms;
+	victim->last_seen_ms = now_ms;
+	return victim;
+}
+
+
+static void track_update_rssi(track_t* track, int rssi, uint32_t now_ms) {
+	if (track->rssi_var == 0.0f) {  // first sample
+		track->rssi = rssi;
+		track->rssi_var = TRACK_RSSI_MEASUREMENT_NOISE;
+		track->rssi_trend_start = rssi;
+		track->rssi_trend_start_ms = now_ms;
+		return;
+	}
+
+	float dt = (now_ms - track->last_seen_ms) / 1000.0f;
+
+	// predict (random walk), then correct
+	track->rssi_var += TRACK_RSSI_PROCESS_NOISE * dt;
+	float gain = track->rssi_var / (track->rssi_var + TRACK_RSSI_MEASUREMENT_NOISE);
+	track->rssi += gain * (rssi - track->rssi);
+	track->rssi_var *= (1.0f - gain);
+
+	// slope samples over at least TRACK_RSSI_TREND_MIN_DT_MS: frames a few ms apart (both radios, repeated beacons)
+	// would otherwise turn filter noise into huge slopes
+	uint32_t trend_ms = now_ms - track->rssi_trend_start_ms;
+	if (trend_ms >= TRACK_RSSI_TREND_MIN_DT_MS) {
+		float slope = (track->rssi - track->rssi_trend_start) / (trend_ms / 1000.0f);
+		track->rssi_trend += TRACK_RSSI_TREND_ALPHA * (slope - track->rssi_trend);
+		track->rssi_trend_start = track->rssi;
+		track->rssi_trend_start_ms = now_ms;
+	}
+}
+
+
+static void track_predict(const track_t* track, uint32_t now_ms, int32_t* lat, int32_t* lon, float* alt) {
+	/*
+	 Position of the transmitter at now_ms, extrapolated from its last position report with the reported velocity.
+	 */
+	float dt = (now_ms - track->position_ms) / 1000.0f;
+
+	*lat = track->lat;
+	*lon = track->lon;
+	*alt = track->alt;
+	if (!track->has_velocity) {
+		return;
+	}
+	*lat += (int32_t) (track->v_north * dt / METERS_PER_E7_DEG);
+	if (track->cos_lat > 0.0f) {
+		*lon += (int32_t) (track->v_east * dt / (METERS_PER_E7_DEG * track->cos_lat));
+	}
+	if (track->has_v_up && track->alt > -1000.0f) {  // -1000 m is "unknown"
+		*alt += track->v_up * dt;
+	}
+}
+
+
+static bool track_predicted_position(const track_t* track, uint32_t now_ms, int32_t* lat, int32_t* lon, float* alt) {
+	/*
+	 Position to report for a frame without a Location/Vector message. False if the track has no position report
+	 within TRACK_PREDICT_MAX_MS.
+	 */
+	if (!track->has_position || now_ms - track->position_ms > TRACK_PREDICT_MAX_MS) {
+		return false;
+	}
+	track_predict(track, now_ms, lat, lon, alt);
+	return true;
+}
+
+
+static void track_update_position(track_t* track, const rid_data_t* rid, uint32_t now_ms) {
+	if (rid->lat == 0 && rid->lon == 0) {  // 0/0 is "unknown" in ASTM F3411
+		return;
+	}
+
+	track->flags &= ~TRACK_FLAG_INCONSISTENT;
+	if (track->has_position) {
+		int32_t lat;
+		int32_t lon;
+		float alt;
+		track_predict(track, now_ms, &lat, &lon, &alt);
+
+		float d_north = ((float) rid->lat - lat) * METERS_PER_E7_DEG;
+		float d_east = ((float) rid->lon - lon) * METERS_PER_E7_DEG * track->cos_lat;
+		// -1000 m is "unknown"; without a vertical speed the altitude can not be predicted, so it is not gated
+		bool alt_known = rid->geodetic_altitude > -1000.0f && alt > -1000.0f && (track->has_v_up || !track->has_velocity);
+		float d_up = alt_known ? rid->geodetic_altitude - alt : 0.0f;
+		float dt = (now_ms - track->position_ms) / 1000.0f;
+
+		track->position_error = sqrt_approx(d_north * d_north + d_east * d_east);
+		if (track->position_error > TRACK_GATE_M + TRACK_GATE_M_PER_S * dt ||
+		    d_up > TRACK_ALT_GATE_M + TRACK_GATE_M_PER_S * dt || -d_up > TRACK_ALT_GATE_M + TRACK_GATE_M_PER_S * dt) {
+			track->flags |= TRACK_FLAG_INCONSISTENT;
+			if (track->inconsistent_count < UINT8_MAX) {
+				track->inconsistent_count++;
+			}
+		} else if (track->inconsistent_count > 0) {
+			track->inconsistent_count--;
+		}
+		if (track->inconsistent_count >= TRACK_SUSPECT_THRESHOLD) {
+			track->flags |= TRACK_FLAG_SUSPECT;
+		} else if (track->inconsistent_count == 0) {
+			track->flags &= ~TRACK_FLAG_SUSPECT;
+		}
+	}
+
+	// re-anchor the motion model on the new report
+	track->has_position = true;
+	track->position_ms = now_ms;
+	track->lat = rid->lat;
+	track->lon = rid->lon;
+	track->alt = rid->geodetic_altitude;
+	track->cos_lat = cos_deg(rid->lat / 10000000.0f);
+
+	// 361 deg and 254.25 m/s are the "unknown" encodings
+	track->has_velocity = rid->track_direction <= 360 && rid->speed < 254.25f;
+	if (track->has_velocity) {
+		track->v_north = rid->speed * cos_deg(rid->track_direction);
+		track->v_east = rid->speed * sin_deg(rid->track_direction);
+		track->has_v_up = rid->vertical_speed < ODID_VERTICAL_SPEED_UNKNOWN;
+		track->v_up = track->has_v_up ? rid->vertical_speed : 0.0f;
+	}
+}
+
+
+static uint8_t track_loss_percent(const track_t* track) {
+	/*
+	 Share of the counters covered by the receive windows that were not received (recent packet loss).
+	 */
+	uint32_t covered = 0;
+	uint32_t received = 0;
+
+	for (int type=0; type<TRACK_COUNTER_TYPES; type++) {
+		if (track->counter_valid & (1 << type)) {
+			covered += track->counter_span[type];
+			received += __builtin_popcount(track->counter_window[type]);
+		}
+	}
+	return covered > 0 ? (covered - received) * 100 / covered : 0;
+}
+
+
+static void track_update(track_t* track, int rssi, const msg_flags_t* msg_flags, const rid_data_t* rid, uint32_t now_ms) {
+	/*
+	 Feed one received frame into the track of its transmitter (from track_lookup).
+
+	 @param[in]  track: track of the transmitter address
+	 @param[in]  rssi: RSSI of the frame in dBm
+	 @param[in]  msg_flags: which messages were decoded from the frame
+	 @param[in]  rid: decoded fields; only the location fields are used, and only if a Location/Vector message was received
+	 @param[in]  now_ms: local receive time
+	 */
+	track_update_rssi(track, rssi, now_ms);
+	if (msg_flags->location_vector_flag) {
+		track_update_position(track, rid, now_ms);
+	}
+	track->last_seen_ms = now_ms;
+}
@@ -8,60 +8,37 @@
 #define WIFI_SHELL_MGMT_EVENTS (NET_EVENT_WIFI_SCAN_DONE |		\
 								NET_EVENT_WIFI_RAW_SCAN_RESULT)
 
-// decimal of FA 0B BC 0D
-uint8_t identifier[] = {250, 11, 188, 13};
-
 uint8_t wifi_scan_finished;
 
-struct net_mgmt_event_callback wifi_shell_mgmt_cb;
-
+// boot-to-first-scan timing, used to compare the default and headless build variants
+static bool first_scan_requested;
+static bool first_scan_done;
 
-int wifi_freq_to_channel(int frequency) {
-	int channel = 0;
-
-	if ((frequency <= 2424) && (frequency >= 2401)) {
-		channel = 1;
-	} else if ((frequency <= 2453) && (frequency >= 2425)) {
-		channel = 6;
-	} else if ((frequency <= 2484) && (frequency >= 2454)) {
-		channel = 11;
-	} else if ((frequency <= 5320) && (frequency >= 5180)) {
-		channel = ((frequency - 5180) / 5) + 36;
-	} else if ((frequency <= 5720) && (frequency >= 5500)) {
-		channel = ((frequency - 5500) / 5) + 100;
-	} else if ((frequency <= 5895) && (frequency >= 5745)) {
-		channel = ((frequency - 5745) / 5) + 149;
-	} else {
-		channel = frequency;
-	}
-
-	return channel;
-}
+// scan scheduling: every other scan only visits the channels of under-sampled tracks, with a longer passive dwell
+#define SCAN_TARGET_INTERVAL_MS 1000  // ASTM F3411 minimum Location/Vector rate; tracks received less often get targeted
+#define SCAN_TARGET_ACTIVE_MS 10000  // tracks not heard from for longer are gone, not under-sampled
+#define SCAN_TARGET_DWELL_MS 300  // per channel, covers a few ODID beacon intervals
 
+static bool last_scan_targeted;
+static uint32_t wifi_scan_failures;  // scan requests the driver rejected, only the first one is logged
+static uint32_t wifi_scans;
+static uint32_t wifi_scans_targeted;
 
-enum wifi_frequency_bands wifi_freq_to_band(int frequency) {
-	enum wifi_frequency_bands band = WIFI_FREQ_BAND_2_4_GHZ;
-
-	if ((frequency  >= 2401) && (frequency <= 2495)) {
-		band = WIFI_FREQ_BAND_2_4_GHZ;
-	} else if ((frequency  >= 5170) && (frequency <= 5895)) {
-		band = WIFI_FREQ_BAND_5_GHZ;
-	} else {
-		band = WIFI_FREQ_BAND_6_GHZ;
-	}
-
-	return band;
-}
+struct net_mgmt_event_callback wifi_shell_mgmt_cb;
 
 
 void handle_wifi_scan_done(struct net_mgmt_event_callback *cb) {
 	const struct wifi_status *status =
 		(const struct wifi_status *)cb->info;
 
+	wifi_scan_finished = 1;  // set global variable to indicate scanning is not longer in progress
 	if (status->status) {
 		LOG_ERR("Scan request failed (%d)", status->status);
 	} else {
-		wifi_scan_finished = 1;  // set global variable to indicate scanning is not longer in progress
+		if (!first_scan_done) {
+			first_scan_done = true;
+			LOG_INF("First scan done %u ms after boot", k_uptime_get_32());
+		}
 		// LOG_INF("Scan request done");
 	}
 }
@@ -82,14 +59,93 @@ static void wifi_mgmt_event_handler(struct net_mgmt_event_callback *cb,
 }
 
 
+static int wifi_scan_plan(struct wifi_scan_params* params) {
+	/*
+	 Pick the channels of the worst served Wi-Fi tracks whose unique frames arrive less often than
+	 SCAN_TARGET_INTERVAL_MS (see ingest.h). The track fields are written by the receive worker; a torn read only
+	 affects which channels get picked. Returns the number of channels.
+	 */
+	uint32_t now = k_uptime_get_32();
+	uint32_t worst[WIFI_MGMT_SCAN_CHAN_MAX_MANUAL];
+	int n = 0;
+
+	for (int i=0; i<MAX_TRACKS; i++) {
+		const track_t* track = &tracks[i];
+		if (!track->in_use || track->source != RID_SOURCE_WIFI || track->channel == 0 ||
+		    now - track->last_unique_ms > SCAN_TARGET_ACTIVE_MS) {
+			continue;
+		}
+		uint32_t interval = MAX((uint32_t) track->rx_interval_ms, now - track->last_unique_ms);
+		if (interval <= SCAN_TARGET_INTERVAL_MS) {
+			continue;
+		}
+
+		int slot = -1;
+		for (int c=0; c<n; c++) {
+			if (params->band_chan[c].channel == track->channel) {
+				slot = c;
+			}
+		}
+		if (slot < 0 && n < WIFI_MGMT_SCAN_CHAN_MAX_MANUAL) {
+			slot = n++;
+			worst[slot] = 0;
+		} else if (slot < 0) {
+			for (int c=0; c<n; c++) {  // replace the best served channel if this track is worse off
+				if (worst[c] < interval && (slot < 0 || worst[c] < worst[slot])) {
+					slot = c;
+				}
+			}
+			if (slot < 0) {
+				continue;
+			}
+			worst[slot] = 0;
+		}
+		params->band_chan[slot].channel = track->channel;
+		params->band_chan[slot].band = track->channel <= 14 ? WIFI_FREQ_BAND_2_4_GHZ : WIFI_FREQ_BAND_5_GHZ;
+		worst[slot] = MAX(worst[slot], interval);
+	}
+
+	if (n > 0) {
+		params->scan_type = WIFI_SCAN_TYPE_PASSIVE;
+		params->dwell_time_passive = SCAN_TARGET_DWELL_MS;
+	}
+	return n;
+}
+
+
 static int wifi_scan(void) {
 	wifi_scan_finished = 0;  // set global variable to indicate scanning currently in progresss
 	
 	struct net_if *iface = net_if_get_default();
-
-	if (net_mgmt(NET_REQUEST_WIFI_SCAN, iface, NULL, 0)) {
-		LOG_ERR("Scan request failed");
+	struct wifi_scan_params params = {0};
+
+	// alternate full scans (to discover new transmitters) with targeted ones while some tracks are under-sampled
+	bool targeted = !last_scan_targeted && wifi_scan_plan(&params) > 0;
+	last_scan_targeted = targeted;
+
+	if (net_mgmt(NET_REQUEST_WIFI_SCAN, iface, targeted ? &params : NULL, targeted ? sizeof(params) : 0)) {
+		// no scan in progress, so the main loop keeps exporting (and retrying); e.g. native_sim has no Wi-Fi device
+		wifi_scan_finished = 1;
+		if (wifi_scan_failures++ == 0) {
+			LOG_ERR("Scan request failed");
+		}
 		return -ENOEXEC;
 	}
+	wifi_scans++;
+	if (targeted) {
+		wifi_scans_targeted++;
+	}
+	if (!first_scan_requested) {
+		first_scan_requested = true;
+		LOG_INF("First scan requested %u ms after boot", k_uptime_get_32());
+	}
 	return 0;
-}
\ No newline at end of file
+}
+
+
+static void wifi_scan_print_stats(void) {
+	/*
+	 Log the scan counts (main loop stats tick).
+	 */
+	LOG_INF("Wi-Fi scans: %u (%u targeted), %u requests failed", wifi_scans, wifi_scans_targeted, wifi_scan_failures);
+}
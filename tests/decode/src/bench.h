@@ -0,0 +1,123 @@
+// Cycles/op benchmarks of the decode path.
+//
+// native_sim's k_cycle_get_32() only advances with simulated time, not while code runs, so on an x86 host the TSC is
+// read instead. Each benchmark reports the best of BENCH_RUNS runs (preemption by the host only ever adds cycles).
+// TSC rates and clock speeds differ between machines, so a result is compared as a ratio to the calibration loop
+// below, which runs before every run of a benchmark: the baselines are in per mille of its cycles, and in builds
+// with BENCH_CHECK (-DBENCH_CHECK=ON, set by the twister scenarios) a benchmark fails when its ratio is more than
+// BENCH_REGRESSION_PERCENT above its baseline. To rebaseline, copy the reported ratios into the table below.
+
+#if defined(CONFIG_ARCH_POSIX) && (defined(__x86_64__) || defined(__i386__))
+#define BENCH_HAS_CYCLES 1
+#elif defined(CONFIG_ARCH_POSIX)
+#define BENCH_HAS_CYCLES 0  // no cycle counter that runs with the host
+#else
+#define BENCH_HAS_CYCLES 1
+#endif
+
+#ifndef BENCH_REGRESSION_PERCENT
+#define BENCH_REGRESSION_PERCENT 100
+#endif
+
+#define BENCH_RUNS 5
+#define BENCH_ITERATIONS 2000
+#define BENCH_CALIBRATION_BYTES 64
+#define BENCH_CALIBRATION_ITERATIONS 200
+
+// baselines in per mille of the calibration loop
+#define BENCH_BASELINE_CONTAINS_HIT 5400  // ODID IE at the end of a 256 byte beacon
+#define BENCH_BASELINE_CONTAINS_MISS 6300
+#define BENCH_BASELINE_PARSE_BASIC_ID 100
+#define BENCH_BASELINE_PARSE_LOCATION 220
+#define BENCH_BASELINE_PARSE_SELF_ID 100
+#define BENCH_BASELINE_PARSE_SYSTEM 140
+#define BENCH_BASELINE_PARSE_OPERATOR_ID 90
+#define BENCH_BASELINE_PARSE_PACK 400  // all five of the above
+#define BENCH_BASELINE_FREQ_TO_CHANNEL 70
+#define BENCH_BASELINE_FREQ_TO_BAND 50
+#define BENCH_BASELINE_LOG_HEXDUMP 32000  // 16 bytes, printk() to a discarding console
+
+// parse_hex() of the default variant, which also prints the decoded fields (to a discarding console)
+#define BENCH_BASELINE_PARSE_PRINT_BASIC_ID 9200
+#define BENCH_BASELINE_PARSE_PRINT_LOCATION 49000
+#define BENCH_BASELINE_PARSE_PRINT_SELF_ID 6000
+#define BENCH_BASELINE_PARSE_PRINT_SYSTEM 28000
+#define BENCH_BASELINE_PARSE_PRINT_OPERATOR_ID 4200
+#define BENCH_BASELINE_PARSE_PRINT_PACK 95000
+
+typedef void (*bench_op_t)(void);
+
+static volatile int bench_sink;  // keeps the results of the benchmarked calls alive
+static uint8_t bench_calibration_data[BENCH_CALIBRATION_BYTES];
+static uint32_t bench_calibration_cycles;  // of the last bench_cycles_per_op()
+
+
+static inline uint32_t bench_cycles(void) {
+#if defined(CONFIG_ARCH_POSIX) && BENCH_HAS_CYCLES
+	return (uint32_t) __builtin_ia32_rdtsc();
+#else
+	return k_cycle_get_32();
+#endif
+}
+
+
+static void bench_calibration(void) {
+	/*
+	 FNV-1a over BENCH_CALIBRATION_BYTES bytes: a chain of dependent loads, XORs and multiplies, which takes about the
+	 same number of core cycles on any recent core and so scales with the clock the benchmarks run at.
+	 */
+	uint32_t hash = 2166136261u;
+
+	for (int i=0; i<BENCH_CALIBRATION_BYTES; i++) {
+		hash = (hash ^ bench_calibration_data[i]) * 16777619u;
+	}
+	bench_sink += hash;
+}
+
+
+static uint32_t bench_loop(bench_op_t op, int iterations) {
+	uint32_t start = bench_cycles();
+
+	for (int i=0; i<iterations; i++) {
+		op();
+	}
+	return bench_cycles() - start;
+}
+
+
+static uint32_t bench_cycles_per_op(bench_op_t op, int iterations, int ops_per_call) {
+	/*
+	 Best of BENCH_RUNS runs of op, in cycles per operation (op may do ops_per_call operations per call). Every run is
+	 preceded by a run of the calibration loop, so bench_calibration_cycles is measured at the same clock.
+	 */
+	uint32_t best = UINT32_MAX;
+
+	bench_calibration_cycles = UINT32_MAX;
+	op();  // warm up the caches
+	for (int run=0; run<BENCH_RUNS; run++) {
+		uint32_t calibration = bench_loop(bench_calibration, BENCH_CALIBRATION_ITERATIONS);
+		uint32_t cycles = bench_loop(op, iterations);
+
+		bench_calibration_cycles = MIN(bench_calibration_cycles, MAX(calibration / BENCH_CALIBRATION_ITERATIONS, 1));
+		best = MIN(best, cycles / ((uint32_t) iterations * ops_per_call));
+	}
+	return best;
+}
+
+
+static void bench_check(const char* name, uint32_t cycles, uint32_t baseline) {
+	/*
+	 Report the result of the last bench_cycles_per_op() (in a fixed format that is easy to collect from the twister
+	 logs), and with BENCH_CHECK fail on a regression against the baseline ratio.
+	 */
+	uint32_t ratio = (uint64_t) cycles * 1000 / bench_calibration_cycles;
+
+	printk("BENCH %-24s %8u cycles/op  calibration %4u  %6u permille  baseline %6u\n", name, cycles,
+	       bench_calibration_cycles, ratio, baseline);
+#ifdef BENCH_CHECK
+	uint32_t limit = (uint64_t) baseline * (100 + BENCH_REGRESSION_PERCENT) / 100;
+
+	zassert_true(ratio <= limit, "%s: %u permille of the calibration loop, more than %u%% above the baseline of %u",
+		     name, ratio, BENCH_REGRESSION_PERCENT, baseline);
+#endif
+}
@@ -0,0 +1,979 @@
+/*
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief Correctness vectors and cycles/op benchmarks of the decode path (src/utils.c), and tests of the header-only
+ * modules around it: tracks, the scan result queue, message counter ingest, the time base and the export
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/net/wifi_mgmt.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+
+#if __has_include(<zephyr/sys/printk-hooks.h>)
+#include <zephyr/sys/printk-hooks.h>
+#else
+extern void __printk_hook_install(int (*fn)(int));
+extern void* __printk_get_hook(void);
+#endif
+extern void __stdout_hook_install(int (*hook)(int));  // printf() of the libc, see test_bench_parse_hex
+
+LOG_MODULE_REGISTER(test, LOG_LEVEL_INF);
+
+#include "enums.h"
+#include "utils.h"
+#include "timebase.h"
+#include "latency.h"
+#include "report.h"  // and track.h
+#include "export.h"
+#include "rx_queue.h"
+#include "ingest.h"
+
+#include "vectors.h"
+#include "bench.h"
+
+
+static uint8_t frame[VECTOR_FRAME_SIZE];
+static int frame_len;
+static msg_flags_t msg_flags;
+static rid_data_t rid;
+
+// printk output of log_hexdump(), captured through the printk hook
+static char printk_capture[128];
+static size_t printk_capture_len;
+
+
+static int printk_capture_char(int c) {
+	if (printk_capture_len < sizeof(printk_capture) - 1) {
+		printk_capture[printk_capture_len++] = c;
+	}
+	return c;
+}
+
+
+static void decode(const uint8_t* const msgs[], int num_msg) {
+	frame_len = vector_beacon(frame, msgs, num_msg);
+	memset(&msg_flags, 0, sizeof(msg_flags));
+	memset(&rid, 0, sizeof(rid));
+	parse_hex(frame, frame_len, VECTOR_ODID_IDX, num_msg, &msg_flags, &rid);
+}
+
+
+ZTEST_SUITE(decode, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(decode, test_contains) {
+	uint8_t big[] = {0x00, 0xDD, 0xFA, 0xFA, 0x0B, 0xBC, 0x0D, 0x2A, 0xFA, 0x0B, 0xBC};
+	uint8_t last_differs[] = {0xFA, 0x0B, 0xBC, 0x0E};
+	uint8_t other[] = {0x00, 0x00};
+	uint8_t one[] = {0x2A};
+
+	zassert_equal(contains(big, sizeof(big), vector_odid_identifier, 4), 3, "after a partial match");
+	zassert_equal(contains(big, 7, vector_odid_identifier, 4), 3, "at the end");
+	zassert_equal(contains(big, 6, vector_odid_identifier, 4), -1, "cut off by the end of the buffer");
+	zassert_equal(contains(&big[8], 3, vector_odid_identifier, 4), -1, "partial match at the end");
+	zassert_equal(contains(big, sizeof(big), last_differs, 4), -1, "last byte differs");
+	zassert_equal(contains(big, sizeof(big), other, sizeof(other)), -1, "not found");
+	zassert_equal(contains(big, sizeof(big), one, sizeof(one)), 7, "single byte");
+	zassert_equal(contains(big, 0, vector_odid_identifier, 4), -1, "empty buffer");
+	zassert_equal(contains(big, sizeof(big), vector_odid_identifier, 0), -1, "empty pattern");
+
+	frame_len = vector_beacon(frame, (const uint8_t* const[]) {vector_basic_id}, 1);
+	zassert_equal(contains(frame, frame_len, vector_odid_identifier, 4), VECTOR_ODID_IDX, "beacon");
+}
+
+ZTEST(decode, test_parse_hex_basic_id) {
+	decode((const uint8_t* const[]) {vector_basic_id}, 1);
+
+	zassert_true(msg_flags.basic_id_flag);
+	zassert_false(msg_flags.location_vector_flag || msg_flags.system_flag || msg_flags.self_id_flag ||
+		      msg_flags.operator_id_flag);
+	zassert_equal(rid.id_type, SERIAL_NUMBER_ANSI_CTA_2063_A);
+	zassert_equal(rid.ua_type, HELICOPTER_MULTIROTOR);
+	zassert_mem_equal(rid.uas_id, "1596F12345678901ABCD", sizeof(rid.uas_id));
+}
+
+ZTEST(decode, test_parse_hex_location) {
+	decode((const uint8_t* const[]) {vector_location}, 1);
+
+	zassert_true(msg_flags.location_vector_flag);
+	zassert_false(msg_flags.basic_id_flag);
+	zassert_equal(rid.op_status, AIRBORNE);
+	zassert_equal(rid.track_direction, 270);
+	zassert_within(rid.speed, 10.0f, 0.001f);
+	zassert_within(rid.vertical_speed, -3.0f, 0.001f);
+	zassert_equal(rid.lat, 423601000);
+	zassert_equal(rid.lon, -710942000);
+	zassert_within(rid.pressure_altitude, 120.0f, 0.001f);
+	zassert_within(rid.geodetic_altitude, 150.0f, 0.001f);
+	zassert_within(rid.height, 50.0f, 0.001f);
+	zassert_equal(rid.timestamp, 12345);
+	zassert_equal(rid.timestamp_accuracy, 3);
+
+	decode((const uint8_t* const[]) {vector_location_fast}, 1);
+
+	zassert_equal(rid.op_status, GROUND);
+	zassert_equal(rid.track_direction, 179);
+	zassert_within(rid.speed, 138.75f, 0.001f);
+	zassert_within(rid.vertical_speed, 2.0f, 0.001f);
+	zassert_within(rid.height, 0.0f, 0.001f);
+	zassert_equal(rid.timestamp, 0xFFFF);
+}
+
+ZTEST(decode, test_parse_hex_self_id_operator_id) {
+	decode((const uint8_t* const[]) {vector_self_id}, 1);
+	zassert_true(msg_flags.self_id_flag);
+	zassert_false(msg_flags.operator_id_flag);
+
+	decode((const uint8_t* const[]) {vector_operator_id}, 1);
+	zassert_true(msg_flags.operator_id_flag);
+	zassert_false(msg_flags.self_id_flag);
+}
+
+ZTEST(decode, test_parse_hex_system) {
+	decode((const uint8_t* const[]) {vector_system}, 1);
+
+	zassert_true(msg_flags.system_flag);
+	zassert_equal(rid.operator_lat, 423590000);
+	zassert_equal(rid.operator_lon, -710930000);
+	zassert_equal(rid.system_timestamp, 250000000);
+}
+
+ZTEST(decode, test_parse_hex_authentication) {
+	// not decoded, must not set any flag
+	decode((const uint8_t* const[]) {vector_authentication}, 1);
+
+	zassert_false(msg_flags.basic_id_flag || msg_flags.location_vector_flag || msg_flags.authentication_flag ||
+		      msg_flags.self_id_flag || msg_flags.system_flag || msg_flags.operator_id_flag);
+}
+
+ZTEST(decode, test_parse_hex_pack) {
+	decode((const uint8_t* const[]) {vector_basic_id, vector_location, vector_authentication, vector_self_id,
+					 vector_system, vector_operator_id}, 6);
+
+	zassert_true(msg_flags.basic_id_flag && msg_flags.location_vector_flag && msg_flags.self_id_flag &&
+		     msg_flags.system_flag && msg_flags.operator_id_flag);
+	zassert_equal(rid.ua_type, HELICOPTER_MULTIROTOR);
+	zassert_equal(rid.lat, 423601000);
+	zassert_equal(rid.operator_lon, -710930000);
+}
+
+ZTEST(decode, test_wifi_freq_to_channel) {
+	// 2.4 GHz frequencies are grouped to the non-overlapping channels 1, 6 and 11
+	zassert_equal(wifi_freq_to_channel(2412), 1);
+	zassert_equal(wifi_freq_to_channel(2424), 1);
+	zassert_equal(wifi_freq_to_channel(2437), 6);
+	zassert_equal(wifi_freq_to_channel(2462), 11);
+	zassert_equal(wifi_freq_to_channel(2484), 11);
+	zassert_equal(wifi_freq_to_channel(5180), 36);
+	zassert_equal(wifi_freq_to_channel(5320), 64);
+	zassert_equal(wifi_freq_to_channel(5500), 100);
+	zassert_equal(wifi_freq_to_channel(5745), 149);
+	zassert_equal(wifi_freq_to_channel(5825), 165);
+	zassert_equal(wifi_freq_to_channel(5955), 5955, "unknown frequencies are returned as is");
+
+	zassert_equal(wifi_freq_to_exact_channel(2412), 1);
+	zassert_equal(wifi_freq_to_exact_channel(2472), 13);
+	zassert_equal(wifi_freq_to_exact_channel(2484), 14);
+	zassert_equal(wifi_freq_to_exact_channel(5180), 36);
+	zassert_equal(wifi_freq_to_exact_channel(5885), 177);
+	zassert_equal(wifi_freq_to_exact_channel(5955), 0);
+}
+
+ZTEST(decode, test_wifi_freq_to_band) {
+	zassert_equal(wifi_freq_to_band(2412), WIFI_FREQ_BAND_2_4_GHZ);
+	zassert_equal(wifi_freq_to_band(2484), WIFI_FREQ_BAND_2_4_GHZ);
+	zassert_equal(wifi_freq_to_band(5180), WIFI_FREQ_BAND_5_GHZ);
+	zassert_equal(wifi_freq_to_band(5885), WIFI_FREQ_BAND_5_GHZ);
+	zassert_equal(wifi_freq_to_band(5955), WIFI_FREQ_BAND_6_GHZ);
+}
+
+ZTEST(decode, test_log_hexdump) {
+	uint8_t buf[] = {0x0A, 0xFF, 0x00, 0x10, 0xBC};
+	int (*previous)(int) = (int (*)(int)) __printk_get_hook();
+
+	printk_capture_len = 0;
+	__printk_hook_install(printk_capture_char);
+	log_hexdump(buf, sizeof(buf));
+	__printk_hook_install(previous);
+	printk_capture[printk_capture_len] = '\0';
+
+	zassert_str_equal(printk_capture, "0A FF 00 10 BC \n");
+}
+
+
+ZTEST_SUITE(track, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(track, test_track_unknown_vertical_speed) {
+	// a hovering transmitter that reports the vertical speed as unknown must pass the altitude gate
+	uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+	track_t* track = track_lookup(mac, 0);
+	int32_t lat;
+	int32_t lon;
+	float alt;
+
+	decode((const uint8_t* const[]) {vector_location_unknown_vertical_speed}, 1);
+	zassert_within(rid.vertical_speed, ODID_VERTICAL_SPEED_UNKNOWN, 0.001f);
+
+	for (uint32_t now=0; now<=10000; now+=2000) {
+		track_update(track, -60, &msg_flags, &rid, now);
+		zassert_equal(track->flags & (TRACK_FLAG_INCONSISTENT | TRACK_FLAG_SUSPECT), 0, "flagged at %u ms", now);
+	}
+	zassert_equal(track_loss_percent(track), 0);  // no message counters fed in
+	zassert_true(track_predicted_position(track, 11000, &lat, &lon, &alt));
+	zassert_equal(lat, 423601000);
+	zassert_within(alt, 150.0f, 0.001f);
+	zassert_false(track_predicted_position(track, 10000 + TRACK_PREDICT_MAX_MS + 1, &lat, &lon, &alt));
+}
+
+ZTEST(track, test_track_rssi_trend) {
+	uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x02};
+	track_t* track = track_lookup(mac, 0);
+	rid_detection_t det;
+
+	decode((const uint8_t* const[]) {vector_basic_id}, 1);
+
+	// the same transmission on both radios, 1 ms apart: no slope until TRACK_RSSI_TREND_MIN_DT_MS have passed
+	track_update(track, -90, &msg_flags, &rid, 0);
+	track_update(track, -40, &msg_flags, &rid, 1);
+	zassert_equal(track->rssi_trend, 0.0f);
+
+	// approaching at 20 dB/s, a frame every 50 ms
+	for (uint32_t now=50; now<=10000; now+=50) {
+		track_update(track, -90 + now / 50, &msg_flags, &rid, now);
+	}
+	zassert_within(track->rssi_trend, 20.0f, 2.0f, "%d dB/s * 10", (int) (track->rssi_trend * 10));
+
+	// packed as 0.1 dB/s without wrapping around
+	track->rssi_trend = 5000.0f;
+	build_detection(&det, RID_SOURCE_WIFI, mac, -40, 6, 10000, 0, &msg_flags, &rid, track);
+	zassert_equal(det.rssi_trend, INT16_MAX);
+	track->rssi_trend = -5000.0f;
+	build_detection(&det, RID_SOURCE_WIFI, mac, -40, 6, 10000, 0, &msg_flags, &rid, track);
+	zassert_equal(det.rssi_trend, -INT16_MAX);
+}
+
+
+// export (src/export.h) to a UDP listener on the loopback interface, in the format of the variant
+
+static void export_test_detection(rid_detection_t* det) {
+	// the fields of vector_basic_id and vector_location, as build_detection() fills them
+	memset(det, 0, sizeof(*det));
+	det->magic = RID_DETECTION_MAGIC;
+	det->version = RID_DETECTION_VERSION;
+	det->len = sizeof(*det);
+	det->rx_uptime_ms = 123456;
+	det->msg_flags = RID_MSG_BASIC_ID | RID_MSG_LOCATION_VECTOR;
+	det->id_type = SERIAL_NUMBER_ANSI_CTA_2063_A;
+	det->ua_type = HELICOPTER_MULTIROTOR;
+	memcpy(det->uas_id, "1596F12345678901ABCD", sizeof(det->uas_id));
+	det->op_status = AIRBORNE;
+	det->track_direction = 270;
+	det->speed_cms = 1000;
+	det->vertical_speed_cms = -300;
+	det->lat = 423601000;
+	det->lon = -710942000;
+	det->geodetic_altitude_m = 150;
+	det->timestamp = 12345;
+	det->rssi_filtered = -67;
+	det->data_age_ms = RID_DATA_AGE_UNKNOWN;
+}
+
+
+static int export_test_receive(int sock, uint8_t* buf, size_t size, int timeout_ms) {
+	// one datagram, or -1 if none arrived within timeout_ms
+	struct zsock_pollfd fds = {.fd = sock, .events = ZSOCK_POLLIN};
+
+	if (zsock_poll(&fds, 1, timeout_ms) != 1) {
+		return -1;
+	}
+	return zsock_recv(sock, buf, size, 0);
+}
+
+
+static int export_test_count(const uint8_t* buf, int len) {
+	// records in a datagram
+#ifdef EXPORT_FORMAT_BINARY
+	rid_batch_header_t header;
+
+	memcpy(&header, buf, sizeof(header));
+	zassert_equal(header.magic, RID_BATCH_MAGIC);
+	zassert_equal(len, sizeof(header) + header.count * sizeof(rid_detection_t));
+	return header.count;
+#else
+	int count = 0;
+
+	zassert_true(len > 0 && buf[len - 1] == '}');
+	for (int i=0; i + 6 <= len; i++) {
+		count += memcmp(&buf[i], "{\"id\":", 6) == 0;
+	}
+	return count;
+#endif
+}
+
+
+ZTEST_SUITE(export, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(export, test_export_json_record) {
+#ifdef EXPORT_FORMAT_BINARY
+	ztest_test_skip();
+#else
+	rid_detection_t det;
+	char buf[EXPORT_JSON_RECORD_MAX];
+
+	export_test_detection(&det);
+	zassert_equal(export_json_record(buf, sizeof(buf), &det), strlen(buf));
+	zassert_str_equal(buf, "{\"id\":\"1596F12345678901ABCD\",\"aircraft_type\":2,\"current_state\":{"
+			  "\"rx_uptime_ms\":123456,\"timestamp\":12345,\"operational_status\":2,"
+			  "\"position\":{\"lat\":42.3601000,\"lng\":-71.0942000,\"alt\":150},\"track\":270,"
+			  "\"speed\":10.00,\"vertical_speed\":-3.00,\"rssi\":-67,\"flags\":0,\"loss\":0,"
+			  "\"rx_interval_ms\":0,\"rx_utc\":null,\"data_age_ms\":null}}");
+
+	// binary ID, sub-m/s descent, known UTC
+	memset(det.uas_id, 0, sizeof(det.uas_id));
+	det.uas_id[0] = 0x01;
+	det.uas_id[1] = 0xAB;
+	det.vertical_speed_cms = -50;
+	det.time_source = RID_TIME_SYSTEM_MSG;
+	det.rx_utc_ms = 1760000000123ll;
+	det.data_age_ms = -250;
+	export_json_record(buf, sizeof(buf), &det);
+	zassert_not_null(strstr(buf, "{\"id\":\"01AB000000000000000000000000000000000000\","));
+	zassert_not_null(strstr(buf, "\"vertical_speed\":-0.50,"));
+	zassert_not_null(strstr(buf, "\"rx_utc\":1760000000.123,\"data_age_ms\":-250}}"));
+
+	// the widest record still fits EXPORT_JSON_RECORD_MAX (with the separating comma)
+	memset(det.uas_id, 0xFF, sizeof(det.uas_id));
+	det.lat = -899999999;
+	det.lon = -1799999999;
+	det.geodetic_altitude_m = -1000;
+	det.speed_cms = 25425;
+	det.vertical_speed_cms = -6300;
+	det.rx_uptime_ms = UINT32_MAX;
+	det.timestamp = 0xFFFF;
+	det.track_direction = 361;
+	det.rssi_filtered = -128;
+	det.track_flags = 0xFF;
+	det.loss_percent = 100;
+	det.rx_interval_ms = UINT16_MAX;
+	det.data_age_ms = -2000000000;
+	zassert_true(export_json_record(buf, sizeof(buf), &det) < EXPORT_JSON_RECORD_MAX);
+	zassert_true(export_json_record(buf, 16, &det) >= 16, "truncation is reported");
+#endif
+}
+
+ZTEST(export, test_export_flush) {
+	struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(EXPORT_COLLECTOR_PORT)};
+	static uint8_t buf[EXPORT_MAX_DATAGRAM];
+	rid_detection_t det;
+	int sock = zsock_socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+	zassert_true(sock >= 0);
+	zsock_inet_pton(AF_INET, EXPORT_COLLECTOR_ADDR, &addr.sin_addr);
+	zassert_equal(zsock_bind(sock, (struct sockaddr*) &addr, sizeof(addr)), 0);
+	zassert_equal(export_init(), 0);
+	export_test_detection(&det);
+
+	// one record more than a datagram holds: a full datagram and one with the rest
+	for (int i=0; i<EXPORT_BATCH + 1; i++) {
+		export_detection(&det);
+	}
+	export_flush();
+	int len = export_test_receive(sock, buf, sizeof(buf), 1000);
+	zassert_true(len > 0 && len <= EXPORT_MAX_DATAGRAM);
+	zassert_equal(export_test_count(buf, len), EXPORT_BATCH);
+	len = export_test_receive(sock, buf, sizeof(buf), 1000);
+	zassert_equal(export_test_count(buf, len), 1);
+	zassert_equal(k_msgq_num_used_get(&export_queue), 0);
+
+	// between intervals, export_poll() only sends once a datagram is full
+	export_last_send_ms = k_uptime_get_32();
+	for (int i=0; i<EXPORT_BATCH - 1; i++) {
+		export_detection(&det);
+	}
+	export_poll();
+	zassert_equal(export_test_receive(sock, buf, sizeof(buf), 100), -1);
+	export_detection(&det);
+	export_poll();
+	len = export_test_receive(sock, buf, sizeof(buf), 1000);
+	zassert_equal(export_test_count(buf, len), EXPORT_BATCH);
+
+	zsock_close(export_sock);
+	export_sock = -1;
+	zsock_close(sock);
+}
+
+
+// scan result pipeline (src/rx_queue.h): the prefilter and the frames queued for the worker
+
+#define RX_TEST_NAN_ATTRIBUTES 10  // action frame body before the ODID pack
+
+static struct wifi_raw_scan_result rx_test_raw;
+static const uint8_t rx_test_mac[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x03};
+
+
+static int rx_test_action(uint8_t* data) {
+	// a NAN service discovery frame: public action, vendor specific (Wi-Fi Alliance NAN), then the ODID message pack
+	static const uint8_t body[RX_TEST_NAN_ATTRIBUTES] = {0x04, 0x09, 0x50, 0x6F, 0x9A, 0x13, 0x03, 0x00, 0x00, 0x00};
+	int len = vector_beacon(frame, (const uint8_t* const[]) {vector_basic_id, vector_location}, 2) - VECTOR_ODID_IDX;
+
+	memset(data, 0, VECTOR_FRAME_SIZE);
+	data[0] = WIFI_FC_SUBTYPE_ACTION;
+	memcpy(&data[WIFI_MGMT_HDR_LEN], body, sizeof(body));
+	memcpy(&data[WIFI_MGMT_HDR_LEN + sizeof(body)], &frame[VECTOR_ODID_IDX], len);
+	return WIFI_MGMT_HDR_LEN + sizeof(body) + len;
+}
+
+
+static int rx_test_bt(uint8_t* adv, bool flags, bool pack, uint8_t counter) {
+	// advertising data with ODID service data: a Bluetooth 4 Basic ID message or a Bluetooth 5 pack of Basic ID and
+	// Location, optionally after a flags AD structure
+	int len = 0;
+
+	if (flags) {
+		adv[len++] = 2;
+		adv[len++] = 0x01;  // flags
+		adv[len++] = 0x06;
+	}
+	adv[len++] = pack ? ODID_PACK_HDR_LEN + 2 * ODID_MSG_LEN : ODID_BT_HDR_LEN + ODID_MSG_LEN;
+	adv[len++] = BT_DATA_SVC_DATA16;
+	sys_put_le16(ODID_BT_UUID, &adv[len]);
+	len += 2;
+	adv[len++] = ODID_BT_APP_CODE;
+	adv[len++] = counter;
+	if (pack) {
+		adv[len++] = 0xF2;  // message pack, protocol version 2
+		adv[len++] = ODID_MSG_LEN;
+		adv[len++] = 2;
+		memcpy(&adv[len], vector_location, ODID_MSG_LEN);
+		len += ODID_MSG_LEN;
+	}
+	memcpy(&adv[len], vector_basic_id, ODID_MSG_LEN);
+	return len + ODID_MSG_LEN;
+}
+
+
+static void rx_test_decode(const rx_frame_t* queued) {
+	memset(&msg_flags, 0, sizeof(msg_flags));
+	memset(&rid, 0, sizeof(rid));
+	parse_hex((uint8_t*) queued->data, queued->len, 0, queued->num_msg_in_pack, &msg_flags, &rid);
+}
+
+
+static void rx_before(void* fixture) {
+	ARG_UNUSED(fixture);
+	k_msgq_purge(&rx_queue);
+}
+
+
+ZTEST_SUITE(rx, NULL, NULL, rx_before, NULL, NULL);
+
+ZTEST(rx, test_rx_prefilter_beacon) {
+	frame_len = vector_beacon(frame, (const uint8_t* const[]) {vector_basic_id, vector_location}, 2);
+
+	zassert_equal(rid_frame_prefilter(frame, frame_len, VECTOR_FRAME_SIZE), VECTOR_ODID_IDX);
+	frame[0] = WIFI_FC_SUBTYPE_PROBE_RESP;
+	zassert_equal(rid_frame_prefilter(frame, frame_len, VECTOR_FRAME_SIZE), VECTOR_ODID_IDX, "probe response");
+	frame[VECTOR_ODID_IDX + 3] = 0x0E;
+	zassert_equal(rid_frame_prefilter(frame, frame_len, VECTOR_FRAME_SIZE), -1, "other vendor IE");
+}
+
+ZTEST(rx, test_rx_prefilter_truncated) {
+	frame_len = vector_beacon(frame, (const uint8_t* const[]) {vector_basic_id, vector_location}, 2);
+
+	zassert_equal(rid_frame_prefilter(frame, frame_len - 1, VECTOR_FRAME_SIZE), -1, "frame ends inside the IE");
+	zassert_equal(rid_frame_prefilter(frame, frame_len, frame_len - 1), -1, "scan result shorter than the frame");
+	zassert_equal(rid_frame_prefilter(frame, WIFI_MGMT_HDR_LEN, VECTOR_FRAME_SIZE), -1, "header only");
+
+	frame[VECTOR_BEACON_HDR_LEN + 1] += ODID_MSG_LEN;
+	zassert_equal(rid_frame_prefilter(frame, frame_len, VECTOR_FRAME_SIZE), -1, "IE length past the end");
+	frame[VECTOR_BEACON_HDR_LEN + 1] -= ODID_MSG_LEN;
+	frame[VECTOR_ODID_IDX + 7] = 3;
+	zassert_equal(rid_frame_prefilter(frame, frame_len, VECTOR_FRAME_SIZE), -1, "pack longer than the IE");
+	frame[VECTOR_ODID_IDX + 7] = ODID_MAX_MSGS_IN_PACK + 1;
+	zassert_equal(rid_frame_prefilter(frame, VECTOR_FRAME_SIZE, VECTOR_FRAME_SIZE), -1, "too many messages");
+}
+
+ZTEST(rx, test_rx_prefilter_action) {
+	uint8_t action[VECTOR_FRAME_SIZE];
+	int len = rx_test_action(action);
+
+	zassert_equal(rid_frame_prefilter(action, len, sizeof(action)), WIFI_MGMT_HDR_LEN + RX_TEST_NAN_ATTRIBUTES);
+	zassert_equal(rid_frame_prefilter(action, len - 1, sizeof(action)), -1, "pack cut off");
+	action[WIFI_MGMT_HDR_LEN + RX_TEST_NAN_ATTRIBUTES] = 0;
+	zassert_equal(rid_frame_prefilter(action, len, sizeof(action)), -1, "no ODID identifier");
+}
+
+ZTEST(rx, test_rx_prefilter_not_management) {
+	frame_len = vector_beacon(frame, (const uint8_t* const[]) {vector_basic_id, vector_location}, 2);
+
+	frame[0] = 0x88;  // QoS data
+	zassert_equal(rid_frame_prefilter(frame, frame_len, VECTOR_FRAME_SIZE), -1, "data frame");
+	frame[0] = 0x84;  // control (block ack request)
+	zassert_equal(rid_frame_prefilter(frame, frame_len, VECTOR_FRAME_SIZE), -1, "control frame");
+	frame[0] = 0x40;  // probe request
+	zassert_equal(rid_frame_prefilter(frame, frame_len, VECTOR_FRAME_SIZE), -1, "other management subtype");
+}
+
+ZTEST(rx, test_rx_submit_wifi) {
+	rx_frame_t queued;
+
+	rx_test_raw.frame_length = vector_beacon(frame, (const uint8_t* const[]) {vector_basic_id, vector_location}, 2);
+	memcpy(rx_test_raw.data, frame, rx_test_raw.frame_length);
+	memcpy(&rx_test_raw.data[10], rx_test_mac, sizeof(rx_test_mac));
+	rx_test_raw.rssi = -50;
+	rx_test_raw.frequency = 2437;
+	rx_submit(&rx_test_raw);
+
+	// only the message pack is queued
+	zassert_equal(rx_get(&queued), 0);
+	zassert_equal(queued.source, RID_SOURCE_WIFI);
+	zassert_mem_equal(queued.mac, rx_test_mac, sizeof(rx_test_mac));
+	zassert_equal(queued.rssi, -50);
+	zassert_equal(queued.frequency, 2437);
+	zassert_equal(queued.counter, 0x2A);
+	zassert_equal(queued.counter_type, TRACK_COUNTER_PACK);
+	zassert_equal(queued.num_msg_in_pack, 2);
+	zassert_equal(queued.len, ODID_PACK_HDR_LEN + 2 * ODID_MSG_LEN);
+	zassert_mem_equal(queued.data, &frame[VECTOR_ODID_IDX], queued.len);
+
+	rx_test_decode(&queued);
+	zassert_true(msg_flags.basic_id_flag && msg_flags.location_vector_flag);
+	zassert_equal(rid.lat, 423601000);
+}
+
+ZTEST(rx, test_rx_submit_bt4) {
+	// a single message per advertisement, with and without an AD structure before the service data
+	uint8_t adv[64];
+	rx_frame_t queued;
+
+	for (int flags=0; flags<=1; flags++) {
+		int len = rx_test_bt(adv, flags, false, 7);
+
+		rx_submit_bt(rx_test_mac, -70, adv, len);
+		zassert_equal(rx_get(&queued), 0);
+		zassert_equal(queued.source, RID_SOURCE_BT);
+		zassert_equal(queued.counter, 7);
+		zassert_equal(queued.counter_type, vector_basic_id[0] >> 4);
+		zassert_equal(queued.num_msg_in_pack, 1);
+		zassert_equal(queued.len, ODID_PACK_HDR_LEN + ODID_MSG_LEN);
+		zassert_mem_equal(&queued.data[ODID_PACK_HDR_LEN - ODID_BT_HDR_LEN], &adv[flags * 3 + 1],
+				  ODID_BT_HDR_LEN + ODID_MSG_LEN, "flags %d", flags);
+
+		rx_test_decode(&queued);
+		zassert_true(msg_flags.basic_id_flag && !msg_flags.location_vector_flag, "flags %d", flags);
+		zassert_equal(rid.ua_type, vector_basic_id[1] % 16, "flags %d", flags);
+	}
+}
+
+ZTEST(rx, test_rx_submit_bt5) {
+	uint8_t adv[96];
+	rx_frame_t queued;
+
+	for (int flags=0; flags<=1; flags++) {
+		int len = rx_test_bt(adv, flags, true, 9);
+
+		rx_submit_bt(rx_test_mac, -70, adv, len);
+		zassert_equal(rx_get(&queued), 0);
+		zassert_equal(queued.counter, 9);
+		zassert_equal(queued.counter_type, TRACK_COUNTER_PACK);
+		zassert_equal(queued.num_msg_in_pack, 2);
+		zassert_equal(queued.len, ODID_PACK_HDR_LEN + 2 * ODID_MSG_LEN);
+		zassert_mem_equal(queued.data, &adv[flags * 3 + 1], queued.len, "flags %d", flags);
+
+		rx_test_decode(&queued);
+		zassert_true(msg_flags.basic_id_flag && msg_flags.location_vector_flag, "flags %d", flags);
+		zassert_equal(rid.lat, 423601000, "flags %d", flags);
+	}
+
+	// a pack header claiming more messages than the service data holds is not queued
+	int len = rx_test_bt(adv, false, true, 10);
+	adv[ODID_PACK_HDR_LEN] = 3;
+	rx_submit_bt(rx_test_mac, -70, adv, len);
+	zassert_equal(k_msgq_num_used_get(&rx_queue), 0);
+}
+
+
+// message counter ingest (src/ingest.h)
+
+static enum INGEST_RESULT ingest_test(track_t* track, uint8_t source, uint8_t counter, uint8_t variant,
+				      uint32_t now_ms) {
+	/*
+	 Ingest a pack of vector_basic_id and vector_location as the worker does (track_update sets last_seen_ms). Packs
+	 with another variant carry a different Location message, e.g. a newer timestamp.
+	 */
+	uint8_t msgs[2 * ODID_MSG_LEN];
+
+	memcpy(msgs, vector_basic_id, ODID_MSG_LEN);
+	memcpy(&msgs[ODID_MSG_LEN], vector_location, ODID_MSG_LEN);
+	msgs[2 * ODID_MSG_LEN - 1] = variant;
+	enum INGEST_RESULT result = ingest_frame(track, source, TRACK_COUNTER_PACK, counter, msgs, 2, now_ms);
+	track->last_seen_ms = now_ms;
+	return result;
+}
+
+
+static track_t* ingest_test_track(uint8_t id, uint32_t now_ms) {
+	uint8_t mac[6] = {0x02, 0x00, 0x00, 0x00, 0x01, id};
+
+	return track_lookup(mac, now_ms);
+}
+
+
+static void ingest_before(void* fixture) {
+	ARG_UNUSED(fixture);
+	memset(ingest_recent, 0, sizeof(ingest_recent));
+	ingest_unique = 0;
+	ingest_duplicates = 0;
+	ingest_cross_duplicates = 0;
+	ingest_lost = 0;
+	ingest_reordered = 0;
+}
+
+
+ZTEST_SUITE(ingest, NULL, NULL, ingest_before, NULL, NULL);
+
+ZTEST(ingest, test_ingest_in_order) {
+	track_t* track = ingest_test_track(1, 0);
+
+	for (int counter=0; counter<10; counter++) {
+		zassert_equal(ingest_test(track, RID_SOURCE_WIFI, counter, counter, counter * 100), INGEST_NEW);
+	}
+	zassert_equal(track->frames_unique, 10);
+	zassert_equal(track->frames_lost, 0);
+	zassert_equal(track_loss_percent(track), 0);
+	zassert_within(track->rx_interval_ms, 100.0f, 0.01f);
+}
+
+ZTEST(ingest, test_ingest_gaps) {
+	track_t* track = ingest_test_track(2, 0);
+
+	// 3 and 4 never arrive: a third of the window is missing
+	for (int counter=0; counter<=5; counter++) {
+		if (counter != 3 && counter != 4) {
+			zassert_equal(ingest_test(track, RID_SOURCE_WIFI, counter, counter, counter * 100), INGEST_NEW);
+		}
+	}
+	zassert_equal(track_loss_percent(track), 33);
+	zassert_equal(track->frames_lost, 0, "only counted once they leave the window");
+
+	// 40 counters later: the two gaps leave the window, as do the 8 skipped counters that do not fit into it; the
+	// other 31 skipped counters are missing from the new window
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 45, 45, 4500), INGEST_NEW);
+	zassert_equal(track->frames_lost, 10);
+	zassert_equal(ingest_lost, 10);
+	zassert_equal(track_loss_percent(track), (INGEST_WINDOW - 1) * 100 / INGEST_WINDOW);
+}
+
+ZTEST(ingest, test_ingest_counter_wrap) {
+	track_t* track = ingest_test_track(3, 0);
+	uint32_t now = 0;
+
+	for (int counter=250; counter<262; counter++) {
+		zassert_equal(ingest_test(track, RID_SOURCE_WIFI, counter % 256, counter, now), INGEST_NEW, "%d", counter);
+		now += 100;
+	}
+	zassert_equal(track->counter_last[TRACK_COUNTER_PACK], 5);
+	zassert_equal(track->counter_span[TRACK_COUNTER_PACK], 12);
+	zassert_equal(track_loss_percent(track), 0);
+
+	// 255 again is behind the newest counter, and already received
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 255, 255, now), INGEST_DUPLICATE);
+}
+
+ZTEST(ingest, test_ingest_late) {
+	track_t* track = ingest_test_track(4, 0);
+
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 0, 0, 0), INGEST_NEW);
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 1, 1, 100), INGEST_NEW);
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 3, 3, 300), INGEST_NEW);
+	zassert_equal(track_loss_percent(track), 25);
+
+	// 2 arrives after 3: reported, counted as reordered, and no longer missing
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 2, 2, 350), INGEST_LATE);
+	zassert_equal(track->frames_reordered, 1);
+	zassert_equal(ingest_reordered, 1);
+	zassert_equal(track_loss_percent(track), 0);
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 2, 2, 360), INGEST_DUPLICATE);
+	zassert_equal(track->frames_unique, 4);
+}
+
+ZTEST(ingest, test_ingest_same_radio_repeats) {
+	track_t* track = ingest_test_track(5, 0);
+
+	// the same beacon seen again by the next scan
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 7, 0, 0), INGEST_NEW);
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 7, 0, 50), INGEST_DUPLICATE);
+
+	// a new counter with unchanged messages (Bluetooth 4 static messages) is reported once per INGEST_CROSS_WINDOW_MS
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 8, 0, 1000), INGEST_DUPLICATE);
+	zassert_equal(ingest_test(track, RID_SOURCE_WIFI, 9, 0, INGEST_CROSS_WINDOW_MS + 1), INGEST_NEW);
+	zassert_equal(track->frames_duplicate, 2);
+	zassert_equal(ingest_duplicates, 2);
+	zassert_equal(ingest_cross_duplicates, 0);
+}
+
+ZTEST(ingest, test_ingest_cross_radio) {
+	// the Wi-Fi and Bluetooth transports of one drone: own addresses and counters, same messages
+	track_t* wifi = ingest_test_track(6, 0);
+	track_t* bt = ingest_test_track(7, 0);
+
+	zassert_equal(ingest_test(wifi, RID_SOURCE_WIFI, 3, 0, 0), INGEST_NEW);
+	zassert_equal(ingest_test(bt, RID_SOURCE_BT, 17, 0, 20), INGEST_CROSS_DUPLICATE);
+	zassert_equal(ingest_cross_duplicates, 1);
+	zassert_equal(bt->frames_duplicate, 1);
+
+	// a newer Location message on Bluetooth is new, and then a duplicate on Wi-Fi
+	zassert_equal(ingest_test(bt, RID_SOURCE_BT, 18, 1, 100), INGEST_NEW);
+	zassert_equal(ingest_test(wifi, RID_SOURCE_WIFI, 4, 1, 120), INGEST_CROSS_DUPLICATE);
+	zassert_equal(ingest_cross_duplicates, 2);
+	zassert_equal(ingest_duplicates, 0);
+}
+
+
+// time base (src/timebase.h): UTC from System messages and the age of Location/Vector data
+
+#define TIMEBASE_TEST_UTC_S 1704067200ll  // 2024-01-01T00:00:00Z, on the hour
+#define TIMEBASE_TEST_SYSTEM_TIMESTAMP ((uint32_t) (TIMEBASE_TEST_UTC_S - ODID_EPOCH_UNIX_S))
+
+
+static int64_t timebase_test_utc(uint32_t rx_ms) {
+	int64_t utc_ms = 0;
+
+	zassert_equal(timebase_utc(rx_ms, &utc_ms), RID_TIME_SYSTEM_MSG);
+	return utc_ms;
+}
+
+
+static void timebase_reset(void* fixture) {
+	// no reference before and after every test, as at boot
+	ARG_UNUSED(fixture);
+	timebase_set(RID_TIME_NONE, 0, 0);
+	timebase_outliers = 0;
+	timebase_system_samples = 0;
+	timebase_system_rejected = 0;
+}
+
+
+ZTEST_SUITE(timebase, NULL, NULL, timebase_reset, timebase_reset, NULL);
+
+ZTEST(timebase, test_timebase_system_offset) {
+	uint32_t rx = k_uptime_get_32();
+	int64_t utc_ms = 0;
+
+	zassert_equal(timebase_utc(rx, &utc_ms), RID_TIME_NONE);
+	timebase_system_message(0, rx);  // no timestamp
+	zassert_equal(timebase_system_samples, 0);
+
+	// the first System message sets the offset, later ones only raise it (UTC is at least every timestamp)
+	timebase_system_message(TIMEBASE_TEST_SYSTEM_TIMESTAMP, rx);
+	zassert_equal(timebase_test_utc(rx), TIMEBASE_TEST_UTC_S * 1000);
+	timebase_system_message(TIMEBASE_TEST_SYSTEM_TIMESTAMP + 1, rx);
+	zassert_equal(timebase_test_utc(rx), (TIMEBASE_TEST_UTC_S + 1) * 1000);
+	timebase_system_message(TIMEBASE_TEST_SYSTEM_TIMESTAMP, rx);
+	zassert_equal(timebase_test_utc(rx), (TIMEBASE_TEST_UTC_S + 1) * 1000);
+	zassert_equal(timebase_system_samples, 3);
+	zassert_equal(timebase_system_rejected, 0);
+
+	// SNTP takes precedence over System messages
+	timebase_set(RID_TIME_SNTP, timebase_offset_ms - 500, timebase_reference_uptime_ms);
+	timebase_system_message(TIMEBASE_TEST_SYSTEM_TIMESTAMP + 2, rx);
+	zassert_equal(timebase_utc(rx, &utc_ms), RID_TIME_SNTP);
+	zassert_equal(utc_ms, (TIMEBASE_TEST_UTC_S + 1) * 1000 - 500);
+}
+
+ZTEST(timebase, test_timebase_outlier) {
+	uint32_t rx = k_uptime_get_32();
+	uint32_t ahead = TIMEBASE_TEST_SYSTEM_TIMESTAMP + 3600;  // a transmitter with its clock an hour ahead
+
+	timebase_system_message(TIMEBASE_TEST_SYSTEM_TIMESTAMP, rx);
+	for (int i=1; i<TIMEBASE_OUTLIER_RESYNC; i++) {
+		timebase_system_message(ahead, rx);
+		zassert_equal(timebase_test_utc(rx), TIMEBASE_TEST_UTC_S * 1000, "outlier %d", i);
+	}
+	zassert_equal(timebase_system_rejected, TIMEBASE_OUTLIER_RESYNC - 1);
+
+	// one that agrees with the estimate starts the count over
+	timebase_system_message(TIMEBASE_TEST_SYSTEM_TIMESTAMP + 1, rx);
+	zassert_equal(timebase_test_utc(rx), (TIMEBASE_TEST_UTC_S + 1) * 1000);
+	for (int i=1; i<TIMEBASE_OUTLIER_RESYNC; i++) {
+		timebase_system_message(ahead, rx);
+	}
+	zassert_equal(timebase_test_utc(rx), (TIMEBASE_TEST_UTC_S + 1) * 1000);
+
+	// TIMEBASE_OUTLIER_RESYNC in a row: the estimate was wrong
+	timebase_system_message(ahead, rx);
+	zassert_equal(timebase_test_utc(rx), (TIMEBASE_TEST_UTC_S + 3600) * 1000);
+	zassert_equal(timebase_system_rejected, 2 * (TIMEBASE_OUTLIER_RESYNC - 1));
+	zassert_equal(timebase_system_samples, 2 * TIMEBASE_OUTLIER_RESYNC + 1);
+}
+
+ZTEST(timebase, test_timebase_data_age) {
+	int64_t hour_ms = TIMEBASE_TEST_UTC_S * 1000;
+
+	zassert_equal(timebase_data_age(hour_ms + 600500, 6000), 500, "within the hour");
+	zassert_equal(timebase_data_age(hour_ms + 500, 35999), 600, "timestamp from the previous hour");
+	zassert_equal(timebase_data_age(hour_ms - 100, 0), -100, "transmitter clock already in the next hour");
+	zassert_equal(timebase_data_age(hour_ms + 1800000, 0), 1800000, "half an hour old");
+}
+
+ZTEST(timebase, test_timebase_data_age_unknown) {
+	int64_t hour_ms = TIMEBASE_TEST_UTC_S * 1000;
+
+	zassert_equal(timebase_data_age(hour_ms, ODID_TIMESTAMP_UNKNOWN), RID_DATA_AGE_UNKNOWN);
+	zassert_equal(timebase_data_age(hour_ms, ODID_TIMESTAMPS_PER_HOUR), RID_DATA_AGE_UNKNOWN, "out of range");
+}
+
+
+// benchmarks, see bench.h
+
+static const uint8_t* const bench_pack[] = {vector_basic_id, vector_location, vector_self_id, vector_system,
+					     vector_operator_id};
+static uint8_t bench_frames[ARRAY_SIZE(bench_pack) + 1][VECTOR_FRAME_SIZE];
+static uint8_t bench_beacon[VECTOR_FRAME_SIZE];
+static uint8_t bench_empty[VECTOR_FRAME_SIZE];
+static const uint8_t* bench_frame;
+static int bench_num_msg;
+static rid_data_t bench_rid;
+static uint8_t bench_hexdump[16];
+static const uint16_t bench_frequencies[] = {2412, 2417, 2422, 2427, 2432, 2437, 2442, 2447, 2452, 2457, 2462, 2467,
+					     2472, 2484, 5180, 5200, 5220, 5240, 5260, 5280, 5300, 5320, 5500, 5600,
+					     5700, 5745, 5765, 5785, 5805, 5825, 5955, 6415};
+
+
+static void *bench_setup(void) {
+	// every message on its own, then all of them in one pack, as parse_hex() reads them
+	for (int i=0; i<ARRAY_SIZE(bench_pack); i++) {
+		vector_beacon(bench_frames[i], &bench_pack[i], 1);
+	}
+	vector_beacon(bench_frames[ARRAY_SIZE(bench_pack)], bench_pack, ARRAY_SIZE(bench_pack));
+
+	// the ODID IE at the very end of a full size beacon, after other IEs
+	int len = vector_beacon(bench_beacon, (const uint8_t* const[]) {vector_location}, 1);
+	memmove(&bench_beacon[VECTOR_FRAME_SIZE - len + VECTOR_BEACON_HDR_LEN], &bench_beacon[VECTOR_BEACON_HDR_LEN],
+		len - VECTOR_BEACON_HDR_LEN);
+	memset(&bench_beacon[VECTOR_BEACON_HDR_LEN], 0x30, VECTOR_FRAME_SIZE - len);
+	memset(bench_empty, 0x30, sizeof(bench_empty));
+	for (int i=0; i<ARRAY_SIZE(bench_calibration_data); i++) {
+		bench_calibration_data[i] = i;  // written, so the compiler cannot fold the calibration loop into a constant
+	}
+	return NULL;
+}
+
+
+static void bench_before(void* fixture) {
+	ARG_UNUSED(fixture);
+	if (!BENCH_HAS_CYCLES) {
+		ztest_test_skip();
+	}
+}
+
+
+static void bench_contains_hit(void) {
+	bench_sink += contains(bench_beacon, sizeof(bench_beacon), vector_odid_identifier, sizeof(vector_odid_identifier));
+}
+
+
+static void bench_contains_miss(void) {
+	bench_sink += contains(bench_empty, sizeof(bench_empty), vector_odid_identifier, sizeof(vector_odid_identifier));
+}
+
+
+static void bench_parse_hex(void) {
+	msg_flags_t flags = {0};
+
+	parse_hex((uint8_t*) bench_frame, VECTOR_FRAME_SIZE, VECTOR_ODID_IDX, bench_num_msg, &flags, &bench_rid);
+	bench_sink += flags.location_vector_flag;
+}
+
+
+static void bench_freq_to_channel(void) {
+	for (int i=0; i<ARRAY_SIZE(bench_frequencies); i++) {
+		bench_sink += wifi_freq_to_channel(bench_frequencies[i]);
+	}
+}
+
+
+static void bench_freq_to_band(void) {
+	for (int i=0; i<ARRAY_SIZE(bench_frequencies); i++) {
+		bench_sink += wifi_freq_to_band(bench_frequencies[i]);
+	}
+}
+
+
+static int bench_discard_char(int c) {
+	return c;
+}
+
+
+static void bench_log_hexdump(void) {
+	log_hexdump(bench_hexdump, sizeof(bench_hexdump));
+}
+
+
+ZTEST_SUITE(decode_bench, NULL, bench_setup, bench_before, NULL, NULL);
+
+ZTEST(decode_bench, test_bench_contains) {
+	bench_check("contains hit", bench_cycles_per_op(bench_contains_hit, BENCH_ITERATIONS, 1),
+		    BENCH_BASELINE_CONTAINS_HIT);
+	bench_check("contains miss", bench_cycles_per_op(bench_contains_miss, BENCH_ITERATIONS, 1),
+		    BENCH_BASELINE_CONTAINS_MISS);
+}
+
+ZTEST(decode_bench, test_bench_parse_hex) {
+	static const struct {
+		const char* name;
+		uint32_t baseline;
+	} benches[] = {
+#if PRINT_INFO
+		{"parse_hex basic id", BENCH_BASELINE_PARSE_PRINT_BASIC_ID},
+		{"parse_hex location", BENCH_BASELINE_PARSE_PRINT_LOCATION},
+		{"parse_hex self id", BENCH_BASELINE_PARSE_PRINT_SELF_ID},
+		{"parse_hex system", BENCH_BASELINE_PARSE_PRINT_SYSTEM},
+		{"parse_hex operator id", BENCH_BASELINE_PARSE_PRINT_OPERATOR_ID},
+		{"parse_hex pack of 5", BENCH_BASELINE_PARSE_PRINT_PACK},
+#else
+		{"parse_hex basic id", BENCH_BASELINE_PARSE_BASIC_ID},
+		{"parse_hex location", BENCH_BASELINE_PARSE_LOCATION},
+		{"parse_hex self id", BENCH_BASELINE_PARSE_SELF_ID},
+		{"parse_hex system", BENCH_BASELINE_PARSE_SYSTEM},
+		{"parse_hex operator id", BENCH_BASELINE_PARSE_OPERATOR_ID},
+		{"parse_hex pack of 5", BENCH_BASELINE_PARSE_PACK},
+#endif
+	};
+	int (*previous)(int) = (int (*)(int)) __printk_get_hook();
+
+	// the default variant prints the decoded fields with printf(): benchmark the formatting, not the console, in
+	// fewer iterations. There is no getter for the stdout hook, so it goes back to the console's printk hook after.
+	for (int i=0; i<ARRAY_SIZE(benches); i++) {
+		bench_frame = bench_frames[i];
+		bench_num_msg = i < ARRAY_SIZE(bench_pack) ? 1 : ARRAY_SIZE(bench_pack);
+		__stdout_hook_install(bench_discard_char);
+		__printk_hook_install(bench_discard_char);
+		uint32_t cycles = bench_cycles_per_op(bench_parse_hex, PRINT_INFO ? BENCH_ITERATIONS / 10 : BENCH_ITERATIONS, 1);
+		__printk_hook_install(previous);
+		__stdout_hook_install(previous);
+		bench_check(benches[i].name, cycles, benches[i].baseline);
+	}
+}
+
+ZTEST(decode_bench, test_bench_wifi_freq) {
+	bench_check("wifi_freq_to_channel", bench_cycles_per_op(bench_freq_to_channel, BENCH_ITERATIONS,
+								 ARRAY_SIZE(bench_frequencies)), BENCH_BASELINE_FREQ_TO_CHANNEL);
+	bench_check("wifi_freq_to_band", bench_cycles_per_op(bench_freq_to_band, BENCH_ITERATIONS,
+							      ARRAY_SIZE(bench_frequencies)), BENCH_BASELINE_FREQ_TO_BAND);
+}
+
+ZTEST(decode_bench, test_bench_log_hexdump) {
+	int (*previous)(int) = (int (*)(int)) __printk_get_hook();
+
+	__printk_hook_install(bench_discard_char);  // the formatting, not the console
+	uint32_t cycles = bench_cycles_per_op(bench_log_hexdump, BENCH_ITERATIONS / 10, 1);
+	__printk_hook_install(previous);
+	bench_check("log_hexdump 16 bytes", cycles, BENCH_BASELINE_LOG_HEXDUMP);
+}
@@ -0,0 +1,96 @@
+// ODID test vectors (ASTM F3411-22a message layouts, protocol version 2) and a Wi-Fi beacon to carry them.
+
+#define VECTOR_MSG_LEN 25
+#define VECTOR_BEACON_HDR_LEN 36  // management header, timestamp, interval and capabilities
+#define VECTOR_ODID_IDX (VECTOR_BEACON_HDR_LEN + 2)  // after the vendor IE's element ID and length
+#define VECTOR_FRAME_SIZE 256
+
+// Basic ID: serial number, helicopter/multirotor
+static const uint8_t vector_basic_id[VECTOR_MSG_LEN] = {
+	0x02, 0x12, '1', '5', '9', '6', 'F', '1', '2', '3', '4', '5', '6', '7', '8', '9', '0', '1', 'A', 'B', 'C', 'D',
+	0x00, 0x00, 0x00
+};
+
+// Location/Vector: airborne, east-west segment set, speed multiplier 0.25
+static const uint8_t vector_location[VECTOR_MSG_LEN] = {
+	0x12, 0x22,
+	90,  // direction, + 180
+	40,  // speed, 10 m/s
+	0xFA,  // vertical speed, -3 m/s
+	0x68, 0xa3, 0x3f, 0x19,  // lat 42.3601000
+	0xd0, 0xe2, 0x9f, 0xd5,  // lon -71.0942000
+	0xC0, 0x08,  // pressure altitude 120 m
+	0xFC, 0x08,  // geodetic altitude 150 m
+	0x34, 0x08,  // height 50 m
+	0x3B, 0x41,  // accuracies
+	0x39, 0x30,  // timestamp 1234.5 s since the hour
+	0x03,  // timestamp accuracy 0.3 s
+	0x00
+};
+
+// Location/Vector: ground, speed multiplier 0.75, unknown timestamp
+static const uint8_t vector_location_fast[VECTOR_MSG_LEN] = {
+	0x12, 0x11, 179, 100, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xD0, 0x07, 0xD0, 0x07, 0xD0, 0x07,
+	0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00
+};
+
+// Location/Vector: hovering, vertical speed "unknown" (63 m/s) as many broadcasters send it
+static const uint8_t vector_location_unknown_vertical_speed[VECTOR_MSG_LEN] = {
+	0x12, 0x20, 0, 0, 0x7E, 0x68, 0xa3, 0x3f, 0x19, 0xd0, 0xe2, 0x9f, 0xd5, 0xC0, 0x08, 0xFC, 0x08, 0x34, 0x08,
+	0x3B, 0x41, 0x39, 0x30, 0x03, 0x00
+};
+
+// Authentication (not decoded)
+static const uint8_t vector_authentication[VECTOR_MSG_LEN] = {
+	0x22, 0x10, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+	0x11, 0x12, 0x13, 0x14, 0x15, 0x16
+};
+
+// Self-ID: text description
+static const uint8_t vector_self_id[VECTOR_MSG_LEN] = {
+	0x32, 0x00, 'S', 'u', 'r', 'v', 'e', 'y', ' ', 'f', 'l', 'i', 'g', 'h', 't', 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00
+};
+
+// System: operator location, timestamp
+static const uint8_t vector_system[VECTOR_MSG_LEN] = {
+	0x42, 0x01,
+	0x70, 0x78, 0x3f, 0x19,  // operator lat 42.3590000
+	0xb0, 0x11, 0xa0, 0xd5,  // operator lon -71.0930000
+	0x01, 0x00, 0x00, 0xD0, 0x07, 0xD0, 0x07, 0x12, 0xD0, 0x07,
+	0x80, 0xb2, 0xe6, 0x0e,  // 250000000 s since 2019-01-01
+	0x00
+};
+
+// Operator ID
+static const uint8_t vector_operator_id[VECTOR_MSG_LEN] = {
+	0x52, 0x00, 'F', 'I', 'N', '8', '7', 'a', 's', 't', 'r', 'd', 'g', 'e', '1', '2', 'k', '8', 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00
+};
+
+static const uint8_t vector_odid_identifier[] = {0xFA, 0x0B, 0xBC, 0x0D};
+
+
+static int vector_beacon(uint8_t* frame, const uint8_t* const msgs[], int num_msg) {
+	/*
+	 Build a beacon with a message pack of the given messages in frame (VECTOR_FRAME_SIZE bytes, zero padded).
+	 Returns the frame length; the ODID identifier is at VECTOR_ODID_IDX.
+	 */
+	int len = VECTOR_ODID_IDX;
+
+	memset(frame, 0, VECTOR_FRAME_SIZE);
+	frame[0] = 0x80;  // beacon
+	frame[VECTOR_BEACON_HDR_LEN] = 0xDD;  // vendor specific IE
+	frame[VECTOR_BEACON_HDR_LEN + 1] = 8 + num_msg * VECTOR_MSG_LEN;
+	memcpy(&frame[len], vector_odid_identifier, sizeof(vector_odid_identifier));
+	len += sizeof(vector_odid_identifier);
+	frame[len++] = 0x2A;  // message counter
+	frame[len++] = 0xF2;  // message pack, protocol version 2
+	frame[len++] = VECTOR_MSG_LEN;
+	frame[len++] = num_msg;
+	for (int i=0; i<num_msg; i++) {
+		memcpy(&frame[len], msgs[i], VECTOR_MSG_LEN);
+		len += VECTOR_MSG_LEN;
+	}
+	return len;
+}